@@ -3,8 +3,11 @@
 #include "src/eval.h"
 #include "src/transposition.h"
 #include "src/moveOrdering.h"
+#include "src/searchDriver.h"
 #include <iostream>
 #include <chrono>
+#include <string>
+#include <thread>
 #include <vector>
 
 struct BenchmarkResult {
@@ -16,13 +19,113 @@ struct BenchmarkResult {
     double speedup;
 };
 
-int main() {
-    std::vector<std::string> testPositions = {
-        "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",  // Starting position
-        "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",  // Kiwipete
-        "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",  // Endgame position
-        "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1",  // Complex position
-    };
+const std::vector<std::string> testPositions = {
+    "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",  // Starting position
+    "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",  // Kiwipete
+    "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",  // Endgame position
+    "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1",  // Complex position
+};
+
+// Lazy SMP scaling: time for the driver to reach a fixed depth on every
+// test position, for 1, 2, 4, 8 and 16 threads. Each run starts from an
+// empty TT so the thread counts don't help each other.
+void benchmarkThreads(int depth) {
+    std::cout << "=== Lazy SMP Depth-to-Time Scaling (depth " << depth << ") ===" << std::endl;
+    std::cout << "(" << std::thread::hardware_concurrency() << " hardware threads)" << std::endl;
+
+    double baseTime = 0.0;
+    for (size_t threads : {1, 2, 4, 8, 16}) {
+        TranspositionTable tt(128);
+        SearchDriver driver(tt);
+        driver.setThreadCount(threads);
+        SearchLimits limits;
+        limits.depth = depth;
+
+        size_t totalNodes = 0;
+        double totalTime = 0.0;
+        for (const auto& fen : testPositions) {
+            Board board;
+            board.board_from_fen_string(fen);
+            tt.clear();
+            driver.clear();
+            auto start = std::chrono::high_resolution_clock::now();
+            SearchResult result = driver.search(board, limits);
+            auto end = std::chrono::high_resolution_clock::now();
+            totalTime += std::chrono::duration<double>(end - start).count();
+            totalNodes += result.nodes;
+        }
+        if (threads == 1) baseTime = totalTime;
+
+        std::cout << "Threads " << threads << ": " << totalTime << "s, "
+                  << totalNodes << " nodes (" << static_cast<size_t>(totalNodes / totalTime) << " NPS), "
+                  << "time-to-depth speedup " << (baseTime / totalTime) << "x" << std::endl;
+    }
+}
+
+// Nodes and time to a fixed depth with two sets of pruning margins.
+void comparePruning(const std::string& title, const PruningMargins& off, const PruningMargins& on, int depth) {
+    std::cout << "=== " << title << " Node Comparison (depth " << depth << ") ===" << std::endl;
+
+    size_t totalOff = 0, totalOn = 0;
+    for (size_t i = 0; i < testPositions.size(); i++) {
+        size_t nodes[2];
+        double seconds[2];
+        const PruningMargins* settings[2] = {&off, &on};
+        for (int run = 0; run < 2; run++) {
+            TranspositionTable tt(128);
+            SearchDriver driver(tt);
+            driver.setPruningMargins(*settings[run]);
+            SearchLimits limits;
+            limits.depth = depth;
+            Board board;
+            board.board_from_fen_string(testPositions[i]);
+            auto start = std::chrono::high_resolution_clock::now();
+            nodes[run] = driver.search(board, limits).nodes;
+            auto end = std::chrono::high_resolution_clock::now();
+            seconds[run] = std::chrono::duration<double>(end - start).count();
+        }
+        totalOff += nodes[0];
+        totalOn += nodes[1];
+        std::cout << "Position " << (i + 1) << ": off " << nodes[0] << " nodes (" << seconds[0] << "s), "
+                  << "on " << nodes[1] << " nodes (" << seconds[1] << "s)" << std::endl;
+    }
+    std::cout << "Total: off " << totalOff << ", on " << totalOn << " nodes, reduction "
+              << (100.0 * (1.0 - static_cast<double>(totalOn) / totalOff)) << "%" << std::endl;
+}
+
+// Frontier pruning: the reverse futility, futility and razoring margins at
+// their defaults versus all off.
+void benchmarkPruning(int depth) {
+    const PruningMargins on;
+    PruningMargins off = on;
+    off.reverseFutility = off.futility = off.razoring = 0;
+    comparePruning("Frontier Pruning", off, on, depth);
+}
+
+// ProbCut at its default margin versus off, everything else at defaults.
+void benchmarkProbCut(int depth) {
+    const PruningMargins on;
+    PruningMargins off = on;
+    off.probCut = 0;
+    comparePruning("ProbCut", off, on, depth);
+}
+
+int main(int argc, char* argv[]) {
+    // "benchmark threads [depth]" runs the SMP scaling benchmark only,
+    // "benchmark pruning [depth]" the frontier pruning comparison and
+    // "benchmark probcut [depth]" the ProbCut comparison.
+    if (argc > 1 && std::string(argv[1]) == "threads") {
+        benchmarkThreads(argc > 2 ? std::stoi(argv[2]) : 7);
+        return 0;
+    }
+    if (argc > 1 && std::string(argv[1]) == "pruning") {
+        benchmarkPruning(argc > 2 ? std::stoi(argv[2]) : 8);
+        return 0;
+    }
+    if (argc > 1 && std::string(argv[1]) == "probcut") {
+        benchmarkProbCut(argc > 2 ? std::stoi(argv[2]) : 10);
+        return 0;
+    }
 
     std::vector<int> depths = {5, 6, 7};
 
@@ -58,6 +161,7 @@ int main() {
             size_t nodesNew = 0;
             TranspositionTable tt(128);
             KillerMoves killers;
+            TranspositionTable::resetThreadStats();
             auto startNew = std::chrono::high_resolution_clock::now();
             AlphaBetaOptimized(boardNew, depth, NEG_INF, POS_INF, nodesNew, tt, killers);
             auto endNew = std::chrono::high_resolution_clock::now();
@@ -69,6 +173,9 @@ int main() {
                       << timeOld << "s (" << static_cast<size_t>(nodesOld / timeOld) << " NPS)" << std::endl;
             std::cout << "  New: " << nodesNew << " nodes, "
                       << timeNew << "s (" << static_cast<size_t>(nodesNew / timeNew) << " NPS)" << std::endl;
+#if TT_STATS
+            std::cout << "  TT: " << TranspositionTable::threadStats().toString() << std::endl;
+#endif
             std::cout << "  Speedup: " << speedup << "x faster" << std::endl;
             std::cout << "  Node reduction: " << (100.0 * (1.0 - static_cast<double>(nodesNew) / nodesOld)) << "%" << std::endl;
 
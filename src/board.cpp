@@ -1,6 +1,7 @@
 #include "board.h"
 #include "moveGenerator.h"
 #include "types.h"
+#include <algorithm>
 #include <random>
 #include <cstdlib>
 #include <iostream>
@@ -79,6 +80,14 @@ void Board::board_from_fen_string(const std::string& fen_string) {
             }
         }
     }
+
+    zobristKey = computeZobristHash();
+    pawnKey = computePawnKey();
+
+    // A new position starts a new game record.
+    moveStack.clear();
+    nullMoveStack.clear();
+    positionHistory.assign(1, zobristKey);
 }
 
 // Print the board in a human-friendly format.
@@ -182,17 +191,31 @@ uint64_t Board::computeZobristHash() {
     for (int i = 0; i < 64; ++i) {
         const Piece &piece = squares[i];
         if (piece.type != PieceType::NONE) {
-            // Compute piece index quickly: 0-5 for white, 6-11 for black.
-            int pieceIndex = static_cast<int>(piece.type) + ((piece.color == Color::WHITE) ? 0 : 6);
-            hash ^= initZobrist.ZobristArray[i][pieceIndex];
+            hash ^= pieceKey(i, piece);
+        }
+    }
+
+    return hash ^ castleAndEnPassantKey();
+}
+
+uint64_t Board::computePawnKey() const {
+    uint64_t hash = 0;
+    for (int i = 0; i < 64; ++i) {
+        if (squares[i].type == PieceType::PAWN) {
+            hash ^= pieceKey(i, squares[i]);
         }
     }
+    return hash;
+}
+
+uint64_t Board::castleAndEnPassantKey() const {
+    uint64_t hash = 0;
 
-    // Unroll the castling rights loop manually.
-    hash ^= initZobrist.castleRights[0];
-    hash ^= initZobrist.castleRights[1];
-    hash ^= initZobrist.castleRights[2];
-    hash ^= initZobrist.castleRights[3];
+    // Only the rights that are still available contribute to the key.
+    if (castleRights[0]) hash ^= initZobrist.castleRights[0];
+    if (castleRights[1]) hash ^= initZobrist.castleRights[1];
+    if (castleRights[2]) hash ^= initZobrist.castleRights[2];
+    if (castleRights[3]) hash ^= initZobrist.castleRights[3];
 
     // Use bitmask to compute file index for en passant target.
     if (enPassantTarget != -1) {
@@ -202,13 +225,196 @@ uint64_t Board::computeZobristHash() {
     return hash;
 }
 
-uint64_t Board::getZobristHash() {
-    return computeZobristHash();
+// Fold every key into one value so data hashed with one key set (e.g. a saved
+// transposition table) can be checked against the keys of this build.
+uint64_t Board::zobristFingerprint() const {
+    uint64_t digest = 0;
+    auto mix = [&digest](uint64_t key) {
+        digest = (digest << 7 | digest >> 57) ^ key;
+    };
+    for (const auto& squareKeys : initZobrist.ZobristArray) {
+        for (uint64_t key : squareKeys) mix(key);
+    }
+    mix(initZobrist.blackToMove);
+    for (uint64_t key : initZobrist.castleRights) mix(key);
+    for (uint64_t key : initZobrist.enPassantFiles) mix(key);
+    return digest;
+}
+
+bool Board::isInsufficientMaterial() const {
+    // Bare kings, or a single knight or bishop against a bare king.
+    if (whitePieces.size() + blackPieces.size() > 3) {
+        return false;
+    }
+    for (const auto* pieces : {&whitePieces, &blackPieces}) {
+        for (int square : *pieces) {
+            PieceType type = squares[square].type;
+            if (type != PieceType::KING && type != PieceType::KNIGHT && type != PieceType::BISHOP) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+bool Board::isDraw(int ply) {
+    if (isInsufficientMaterial()) {
+        return true;
+    }
+    if (halfMoveClock >= 100) {
+        if (!isKingInCheck(turn)) {
+            return true;
+        }
+        std::vector<Move> moves;
+        generateMoves(moves);
+        return !moves.empty();
+    }
+
+    // Only positions since the last irreversible move can repeat, and only
+    // those with the same side to move; a pass (null move) also ends the
+    // window, since positions across it were never really reached.
+    // positionHistory.back() is the current position.
+    int current = static_cast<int>(positionHistory.size()) - 1;
+    int window = std::min(halfMoveClock, current);
+    if (!nullMoveStack.empty()) {
+        window = std::min(window, current - static_cast<int>(nullMoveStack.back().historySize));
+    }
+    int earlier = 0;
+    for (int back = 4; back <= window; back += 2) {
+        if (positionHistory[current - back] == zobristKey) {
+            if (back <= ply || ++earlier >= 2) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+namespace {
+
+// Cuckoo hash of every reversible piece move (a piece going from one square
+// to another and the side to move flipping), keyed by the Zobrist
+// difference it makes. Two positions whose keys differ by such an entry
+// are one move apart, if the squares between are empty. Each key lives in
+// one of two slots, so a lookup is two probes.
+struct CuckooTable {
+    static constexpr int SIZE = 8192;
+    std::array<uint64_t, SIZE> keys{};
+    std::array<int8_t, SIZE> from{}, to{};
+
+    static int slot1(uint64_t key) { return static_cast<int>(key & (SIZE - 1)); }
+    static int slot2(uint64_t key) { return static_cast<int>((key >> 16) & (SIZE - 1)); }
+
+    explicit CuckooTable(const ZobristArray& zobrist) {
+        static const int knight[8][2] = {{1, 2}, {2, 1}, {2, -1}, {1, -2}, {-1, -2}, {-2, -1}, {-2, 1}, {-1, 2}};
+        static const int lines[8][2] = {{1, 0}, {-1, 0}, {0, 1}, {0, -1}, {1, 1}, {1, -1}, {-1, 1}, {-1, -1}};
+        const PieceType types[] = {PieceType::KNIGHT, PieceType::BISHOP, PieceType::ROOK,
+                                   PieceType::QUEEN, PieceType::KING};
+        for (Color color : {Color::WHITE, Color::BLACK}) {
+            for (PieceType type : types) {
+                int index = static_cast<int>(type) + (color == Color::WHITE ? 0 : 6);
+                for (int s1 = 0; s1 < 64; s1++) {
+                    auto add = [&](int s2) {
+                        if (s2 <= s1) return;  // Each pair once
+                        insert(zobrist.ZobristArray[s1][index] ^ zobrist.ZobristArray[s2][index] ^
+                                   zobrist.blackToMove,
+                               s1, s2);
+                    };
+                    if (type == PieceType::KNIGHT) {
+                        for (const auto& d : knight) {
+                            int file = s1 % 8 + d[0], rank = s1 / 8 + d[1];
+                            if (file >= 0 && file < 8 && rank >= 0 && rank < 8) add(rank * 8 + file);
+                        }
+                        continue;
+                    }
+                    for (int dir = 0; dir < 8; dir++) {
+                        bool straight = dir < 4;
+                        if ((type == PieceType::BISHOP && straight) || (type == PieceType::ROOK && !straight)) {
+                            continue;
+                        }
+                        int file = s1 % 8 + lines[dir][0], rank = s1 / 8 + lines[dir][1];
+                        while (file >= 0 && file < 8 && rank >= 0 && rank < 8) {
+                            add(rank * 8 + file);
+                            if (type == PieceType::KING) break;
+                            file += lines[dir][0];
+                            rank += lines[dir][1];
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    void insert(uint64_t key, int s1, int s2) {
+        int8_t a = static_cast<int8_t>(s1), b = static_cast<int8_t>(s2);
+        int slot = slot1(key);
+        // Kick out whatever is in the slot and move it to its other slot,
+        // until an empty one is reached.
+        while (true) {
+            std::swap(keys[slot], key);
+            std::swap(from[slot], a);
+            std::swap(to[slot], b);
+            if (key == 0) return;
+            slot = (slot == slot1(key)) ? slot2(key) : slot1(key);
+        }
+    }
+
+    // Slot holding key, or -1.
+    int find(uint64_t key) const {
+        int slot = slot1(key);
+        if (keys[slot] == key) return slot;
+        slot = slot2(key);
+        return keys[slot] == key ? slot : -1;
+    }
+};
+
+// The keys are the same for every Board, so one table serves them all.
+const CuckooTable& cuckooTable(const ZobristArray& zobrist) {
+    static const CuckooTable table(zobrist);
+    return table;
+}
+
+// No piece strictly between s1 and s2, which lie on a common line or are a
+// knight's move apart.
+bool pathClear(const std::array<Piece, 64>& squares, int s1, int s2) {
+    int df = s2 % 8 - s1 % 8, dr = s2 / 8 - s1 / 8;
+    if (df != 0 && dr != 0 && std::abs(df) != std::abs(dr)) {
+        return true;  // Knight move
+    }
+    int step = (dr > 0 ? 8 : dr < 0 ? -8 : 0) + (df > 0 ? 1 : df < 0 ? -1 : 0);
+    for (int square = s1 + step; square != s2; square += step) {
+        if (squares[square].type != PieceType::NONE) return false;
+    }
+    return true;
+}
+
+} // namespace
+
+bool Board::hasUpcomingRepetition(int ply) const {
+    // Same window as isDraw(), but looking for a position one move away:
+    // those with the other side to move, at least three plies back.
+    int current = static_cast<int>(positionHistory.size()) - 1;
+    int window = std::min(halfMoveClock, current);
+    if (!nullMoveStack.empty()) {
+        window = std::min(window, current - static_cast<int>(nullMoveStack.back().historySize));
+    }
+    if (window < 3) {
+        return false;
+    }
+
+    const CuckooTable& cuckoo = cuckooTable(initZobrist);
+    for (int back = 3; back <= window && back < ply; back += 2) {
+        int slot = cuckoo.find(zobristKey ^ positionHistory[current - back]);
+        if (slot >= 0 && pathClear(squares, cuckoo.from[slot], cuckoo.to[slot])) {
+            return true;
+        }
+    }
+    return false;
 }
 
 bool Board::isThreefoldRepetition() {
     // Ensure positionHistory is updated in makeMove/unMakeMove.
-    uint64_t currentHash = computeZobristHash();
+    uint64_t currentHash = zobristKey;
     int count = 0;
     for (uint64_t hash : positionHistory) {
         if (hash == currentHash)
@@ -33,6 +33,7 @@ public:
     // std::vector<Move> moveList;   
     // Public constructor.
     Board() {
+        initZobristArray();
         board_from_fen_string(startFEN); 
         
     }
@@ -45,9 +46,24 @@ public:
     GameResult checkGameState();   // Checks if game is ongoing or ended
     bool isFiftyMoveRule();        // Checks 50-move rule
     bool isThreefoldRepetition();  // Checks 3x repetition
-    bool isInsufficientMaterial(); // Checks for insufficient material draw
+    bool isInsufficientMaterial() const; // Checks for insufficient material draw
     bool isStalemate();            // Checks for stalemate
 
+    // Fast draw test for search: fifty-move rule, insufficient material, or
+    // a repetition. A position repeated within the last ply plies (inside
+    // the search tree) is a draw at once; one that only repeats positions
+    // from before the search root needs two earlier occurrences. Moves are
+    // only generated to rule out a mate on the hundredth half-move, which
+    // takes precedence over the fifty-move rule. Stalemate is left to the
+    // caller's move list.
+    bool isDraw(int ply);
+
+    // True if the side to move has a reversible move that recreates a
+    // position from within the search tree (less than ply plies back), so
+    // the node is worth at least a draw. Uses a cuckoo table of the key
+    // difference of every piece move on an empty board.
+    bool hasUpcomingRepetition(int ply) const;
+
     // Parses a FEN string and returns an array of Piece representing the board.
     void board_from_fen_string(const std::string& fen_string);
 
@@ -64,10 +80,22 @@ public:
     bool isSquareAttacked(int Square, Color side);
     bool isMoveLegal(const Move& move);
 
+    // Static exchange evaluation: material balance for the side to move
+    // after move and the best sequence of recaptures on its target square,
+    // with x-ray attackers joining as the pieces in front of them leave.
+    // Pins are ignored.
+    int see(const Move& move) const;
+    bool see_ge(const Move& move, int threshold) const;
+
     // make a move
     void makeMove(const Move& move);
     // unmake the most recent move
     void unMakeMove();
+    // Pass: hand the move to the other side without moving a piece (for
+    // null-move pruning). Must be undone with unmakeNullMove() before any
+    // real move made earlier is unmade.
+    void makeNullMove();
+    void unmakeNullMove();
 
 
     // Prints the board to the console.
@@ -76,11 +104,32 @@ public:
 
     std::string squareToNotation(int square) const ;
     std::string getFEN() const;
-    uint64_t getZobristHash();              // Public getter for Zobrist hash
+    uint64_t getZobristHash() const { return zobristKey; } // Incrementally maintained key
+    uint64_t getPawnKey() const { return pawnKey; }        // Zobrist key of the pawns only
+    uint64_t zobristFingerprint() const;    // Digest of all Zobrist keys
 private:
+    uint64_t zobristKey = 0;                // Updated in makeMove/unMakeMove
+    uint64_t pawnKey = 0;                   // Updated in makeMove/unMakeMove
     std::vector<uint64_t> positionHistory;  // Stores board state hashes for threefold repetition
+
+    // What makeNullMove() changes besides the side to move.
+    struct NullMoveUndo {
+        int prevEnPassantTarget;
+        int prevHalfMoveClock;
+        uint64_t prevZobristKey;
+        size_t historySize;  // positionHistory size before the pass
+    };
+    std::vector<NullMoveUndo> nullMoveStack;
     uint64_t computeZobristHash();          // Computes a unique board hash
+    uint64_t computePawnKey() const;        // Computes the pawn-only hash
     void initZobristArray();
+    uint64_t pieceKey(int square, const Piece& piece) const {
+        return initZobrist.ZobristArray[square][static_cast<int>(piece.type) + (piece.color == Color::WHITE ? 0 : 6)];
+    }
+    uint64_t castleAndEnPassantKey() const;  // Castling + en passant part of the key
+    // Square of the least valuable piece of side attacking square, looking
+    // only at occupied squares; -1 if there is none.
+    int leastValuableAttacker(int square, Color side, const std::array<bool, 64>& occupied) const;
 };
 
 #endif // BOARD_H
@@ -1,9 +1,144 @@
 #include "eval.h"
 #include "board.h"
 #include "types.h"
+#include <atomic>
 
-// Define heuristic function
-int heuristic(Board& board) {
+namespace {
+
+std::atomic<size_t> evalCacheSizeMB{DEFAULT_EVAL_CACHE_MB};
+
+// Pawn structure terms (centipawns).
+constexpr int DOUBLED_PAWN_PENALTY = 12;
+constexpr int ISOLATED_PAWN_PENALTY = 15;
+constexpr int BACKWARD_PAWN_PENALTY = 10;
+constexpr std::array<int, 8> PASSED_PAWN_BONUS = {0, 5, 10, 20, 35, 60, 100, 0}; // By relative rank
+constexpr int SHIELD_PAWN_NEAR = 10; // Pawn on the king's second rank
+constexpr int SHIELD_PAWN_FAR = 5;   // Pawn one rank further
+
+constexpr uint64_t FILE_A = 0x0101010101010101ULL;
+
+inline uint64_t fileMask(int file) {
+    return FILE_A << file;
+}
+inline uint64_t adjacentFilesMask(int file) {
+    return (file > 0 ? fileMask(file - 1) : 0) | (file < 7 ? fileMask(file + 1) : 0);
+}
+// All squares on ranks strictly ahead of rank, from color's point of view.
+inline uint64_t ranksAhead(int rank, int color) {
+    return color == 0 ? (rank == 7 ? 0 : ~0ULL << (8 * (rank + 1)))
+                      : (rank == 0 ? 0 : ~0ULL >> (8 * (8 - rank)));
+}
+inline int wingOf(int file) {
+    return file <= 2 ? 0 : (file <= 4 ? 1 : 2);
+}
+
+// Fill a pawn table entry from scratch. Only runs on a pawn table miss.
+void evaluatePawns(const Board& board, PawnEntry& entry) {
+    uint64_t pawns[2] = {0, 0};
+    for (int sq = 0; sq < 64; sq++) {
+        const Piece& piece = board.squares[sq];
+        if (piece.type == PieceType::PAWN) {
+            pawns[static_cast<int>(piece.color)] |= 1ULL << sq;
+        }
+    }
+
+    int score[2] = {0, 0};
+    for (int color = 0; color < 2; color++) {
+        const uint64_t own = pawns[color];
+        const uint64_t enemy = pawns[color ^ 1];
+        const int forward = color == 0 ? 8 : -8;
+        entry.passed[color] = 0;
+
+        for (int file = 0; file < 8; file++) {
+            int count = __builtin_popcountll(own & fileMask(file));
+            if (count > 1) score[color] -= DOUBLED_PAWN_PENALTY * (count - 1);
+        }
+
+        for (uint64_t bits = own; bits; bits &= bits - 1) {
+            int sq = __builtin_ctzll(bits);
+            int file = sq & 7, rank = sq >> 3;
+            int relativeRank = color == 0 ? rank : 7 - rank;
+            uint64_t ahead = ranksAhead(rank, color);
+
+            if ((enemy & ahead & (fileMask(file) | adjacentFilesMask(file))) == 0) {
+                entry.passed[color] |= 1ULL << sq;
+                score[color] += PASSED_PAWN_BONUS[relativeRank];
+            }
+
+            if ((own & adjacentFilesMask(file)) == 0) {
+                score[color] -= ISOLATED_PAWN_PENALTY;
+            } else if ((own & adjacentFilesMask(file) & ~ahead) == 0) {
+                // No neighbour level with or behind it: backward if an enemy
+                // pawn controls the square in front.
+                int stop = sq + forward;
+                int stopFile = stop & 7;
+                for (int side : {-1, 1}) {
+                    int attackerFile = stopFile + side;
+                    int attacker = stop + forward + side;
+                    if (attackerFile >= 0 && attackerFile < 8 && attacker >= 0 && attacker < 64 &&
+                        (enemy & (1ULL << attacker))) {
+                        score[color] -= BACKWARD_PAWN_PENALTY;
+                        break;
+                    }
+                }
+            }
+        }
+
+        // Pawn shield in front of a king on each wing.
+        const int nearRank = color == 0 ? 1 : 6;
+        const int farRank = color == 0 ? 2 : 5;
+        for (int wing = 0; wing < 3; wing++) entry.shelter[color][wing] = 0;
+        for (int file = 0; file < 8; file++) {
+            int bonus = (own & (1ULL << (nearRank * 8 + file))) ? SHIELD_PAWN_NEAR
+                      : (own & (1ULL << (farRank * 8 + file))) ? SHIELD_PAWN_FAR : 0;
+            entry.shelter[color][wingOf(file)] += bonus;
+        }
+    }
+
+    entry.score = score[0] - score[1];
+}
+
+// Pawn structure, king shelter and passed pawn terms from White's point of view.
+int pawnStructure(const Board& board) {
+    bool found;
+    PawnEntry& entry = threadPawnTable().probe(board.getPawnKey(), found);
+    if (!found) {
+        entry.key = board.getPawnKey();
+        evaluatePawns(board, entry);
+    }
+
+    int score = entry.score;
+
+    // The shield only counts while the king still sits on its back two ranks.
+    const int kingSquares[2] = {board.whiteKingSquare, board.blackKingSquare};
+    for (int color = 0; color < 2; color++) {
+        int king = kingSquares[color];
+        if (king < 0) continue;
+        int relativeRank = color == 0 ? king >> 3 : 7 - (king >> 3);
+        if (relativeRank <= 1) {
+            int shelter = entry.shelter[color][wingOf(king & 7)];
+            score += color == 0 ? shelter : -shelter;
+        }
+    }
+
+    // A passer whose stop square is occupied is worth half as much.
+    for (int color = 0; color < 2; color++) {
+        for (uint64_t bits = entry.passed[color]; bits; bits &= bits - 1) {
+            int sq = __builtin_ctzll(bits);
+            int stop = sq + (color == 0 ? 8 : -8);
+            if (board.squares[stop].type != PieceType::NONE) {
+                int relativeRank = color == 0 ? sq >> 3 : 7 - (sq >> 3);
+                int penalty = PASSED_PAWN_BONUS[relativeRank] / 2;
+                score += color == 0 ? -penalty : penalty;
+            }
+        }
+    }
+
+    return score;
+}
+
+// Material balance plus pawn structure from the side to move's point of view.
+int computeHeuristic(const Board& board) {
     int myMaterial = 0;
     int opponentMaterial = 0;
 
@@ -19,7 +154,42 @@ int heuristic(Board& board) {
         }
     }
 
-    return myMaterial - opponentMaterial;
+    int pawns = pawnStructure(board);
+    return myMaterial - opponentMaterial + (board.turn == Color::WHITE ? pawns : -pawns);
+}
+
+} // namespace
+
+void setEvalCacheSize(size_t sizeMB) {
+    evalCacheSizeMB.store(sizeMB, std::memory_order_relaxed);
+}
+
+EvalCache& threadEvalCache() {
+    thread_local EvalCache cache(evalCacheSizeMB.load(std::memory_order_relaxed));
+    size_t wanted = evalCacheSizeMB.load(std::memory_order_relaxed);
+    if (cache.sizeInMB() != wanted) {
+        cache.resize(wanted);
+    }
+    return cache;
+}
+
+PawnTable& threadPawnTable() {
+    thread_local PawnTable table;
+    return table;
+}
+
+// Define heuristic function
+int heuristic(Board& board) {
+    EvalCache& cache = threadEvalCache();
+    uint64_t key = board.getZobristHash();
+
+    int score;
+    if (cache.probe(key, score)) {
+        return score;
+    }
+    score = computeHeuristic(board);
+    cache.store(key, score);
+    return score;
 }
 // Define evaluation function
 int evaluate(Board& board) {
@@ -1,12 +1,36 @@
 #ifndef EVAL_H
 #define EVAL_H
 #include "board.h"
+#include "evalCache.h"
+#include "pawnTable.h"
 #include <array>
+#include <cstddef>
 
 
 constexpr int CHECKMATE_SCORE = 1000000;
-constexpr int NEG_INF = -CHECKMATE_SCORE;
-constexpr int POS_INF = CHECKMATE_SCORE;int evaluate(Board& board);
+// Deepest ply the search reaches, extensions included.
+constexpr int MAX_PLY = 64;
+// In search, being mated n plies from the root scores -(CHECKMATE_SCORE - n),
+// so shorter mates score higher. Anything beyond MATE_BOUND is such a score.
+constexpr int MATE_BOUND = CHECKMATE_SCORE - MAX_PLY;
+// Window limits, strictly outside every reachable score.
+constexpr int NEG_INF = -CHECKMATE_SCORE - 1;
+constexpr int POS_INF = CHECKMATE_SCORE + 1;
+
+inline bool isMateScore(int score) {
+    return score >= MATE_BOUND || score <= -MATE_BOUND;
+}
+
+int evaluate(Board& board);
 int heuristic(Board& board);
 constexpr std::array<int, 6> pieceValues = {100,350,350,525,1000,10000};
-#endif
\ No newline at end of file
+
+// Each thread evaluates through its own EvalCache. A new size is picked up
+// by every thread the next time it evaluates a position.
+constexpr size_t DEFAULT_EVAL_CACHE_MB = 4;
+void setEvalCacheSize(size_t sizeMB);
+EvalCache& threadEvalCache();
+
+// Per-thread pawn structure cache, keyed by Board::getPawnKey().
+PawnTable& threadPawnTable();
+#endif
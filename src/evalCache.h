@@ -0,0 +1,82 @@
+#ifndef EVAL_CACHE_H
+#define EVAL_CACHE_H
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+#include "types.h"
+
+// Lossy, direct-mapped cache of static evaluations keyed by Zobrist hash.
+// A colliding store simply overwrites the slot; the full key is kept so a
+// probe never returns another position's score.
+class EvalCache {
+private:
+    struct Entry {
+        uint64_t key = 0;
+        int eval = 0;
+    };
+
+    std::vector<Entry> table;
+    size_t mask = 0;
+    size_t sizeMB = 0;
+
+public:
+    // Hit-rate statistics since the last resetStats(); TT_STATS builds only.
+    uint64_t probes = 0;
+    uint64_t hits = 0;
+
+    explicit EvalCache(size_t sizeMB = 4) {
+        resize(sizeMB);
+    }
+
+    void resize(size_t newSizeMB) {
+        size_t entries = 1;
+        while (entries * 2 * sizeof(Entry) <= newSizeMB * 1024 * 1024) {
+            entries *= 2;
+        }
+        table.assign(entries, Entry{});
+        mask = entries - 1;
+        sizeMB = newSizeMB;
+    }
+
+    bool probe(uint64_t key, int& eval) {
+#if TT_STATS
+        probes++;
+#endif
+        const Entry& entry = table[key & mask];
+        // Key 0 marks an empty slot.
+        if (entry.key == key && key != 0) {
+#if TT_STATS
+            hits++;
+#endif
+            eval = entry.eval;
+            return true;
+        }
+        return false;
+    }
+
+    void store(uint64_t key, int eval) {
+        Entry& entry = table[key & mask];
+        entry.key = key;
+        entry.eval = eval;
+    }
+
+    void clear() {
+        table.assign(table.size(), Entry{});
+    }
+
+    void resetStats() {
+        probes = 0;
+        hits = 0;
+    }
+
+    double hitRate() const {
+        return probes == 0 ? 0.0 : static_cast<double>(hits) / probes;
+    }
+
+    size_t sizeInMB() const {
+        return sizeMB;
+    }
+};
+
+#endif // EVAL_CACHE_H
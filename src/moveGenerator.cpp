@@ -4,6 +4,7 @@
 #include <algorithm>
 #include "board.h"
 #include "types.h"
+#include "eval.h"
 
 inline bool isOnBoard(int square) {
     return square >= 0 && square < 64;
@@ -408,6 +409,121 @@ bool Board::isSquareAttacked(int square, Color side) {
 
     return false;
 }
+int Board::leastValuableAttacker(int square, Color side, const std::array<bool, 64>& occupied) const {
+    int best = -1;
+    int bestValue = 0;
+    auto consider = [&](int from) {
+        int value = pieceValues[static_cast<int>(squares[from].type)];
+        if (best == -1 || value < bestValue) {
+            best = from;
+            bestValue = value;
+        }
+    };
+    auto isPiece = [&](int from, PieceType type) {
+        return occupied[from] && squares[from].type == type && squares[from].color == side;
+    };
+    int file = square % 8;
+
+    // Pawns (a pawn of side attacks square from one rank behind it).
+    int pawnFrom[2] = {side == Color::WHITE ? square - 7 : square + 7,
+                       side == Color::WHITE ? square - 9 : square + 9};
+    for (int from : pawnFrom) {
+        if (isOnBoard(from) && std::abs(from % 8 - file) == 1 && isPiece(from, PieceType::PAWN)) {
+            return from;  // Nothing is cheaper
+        }
+    }
+
+    const int knightOffsets[8] = { -17, -15, -10, -6, 6, 10, 15, 17 };
+    for (int offset : knightOffsets) {
+        int from = square + offset;
+        if (isOnBoard(from) && std::abs(from % 8 - file) <= 2 && isPiece(from, PieceType::KNIGHT)) {
+            consider(from);
+        }
+    }
+
+    // Sliders: the first occupied square along each ray. Squares vacated
+    // by earlier captures are skipped, which brings x-ray attackers in.
+    const int directions[8] = { -9, -7, 7, 9, -8, -1, 1, 8 };
+    for (int i = 0; i < 8; i++) {
+        bool diagonal = i < 4;
+        int from = square;
+        while (true) {
+            int prev = from;
+            from += directions[i];
+            if (!isOnBoard(from) || std::abs(from % 8 - prev % 8) > 1) break;
+            if (!occupied[from]) continue;
+            if (squares[from].color == side &&
+                (squares[from].type == PieceType::QUEEN ||
+                 squares[from].type == (diagonal ? PieceType::BISHOP : PieceType::ROOK))) {
+                consider(from);
+            }
+            break;
+        }
+    }
+
+    const int kingOffsets[8] = { -9, -8, -7, -1, 1, 7, 8, 9 };
+    for (int offset : kingOffsets) {
+        int from = square + offset;
+        if (isOnBoard(from) && std::abs(from % 8 - file) <= 1 && isPiece(from, PieceType::KING)) {
+            consider(from);
+        }
+    }
+    return best;
+}
+
+int Board::see(const Move& move) const {
+    const int target = move.targetSquare;
+    std::array<bool, 64> occupied;
+    for (int sq = 0; sq < 64; sq++) {
+        occupied[sq] = squares[sq].type != PieceType::NONE;
+    }
+
+    // gain[d]: what the side making capture d wins if the exchange stops there.
+    int gain[32];
+    int d = 0;
+    PieceType captured = move.isEnPassant ? PieceType::PAWN : squares[target].type;
+    gain[0] = captured == PieceType::NONE ? 0 : pieceValues[static_cast<int>(captured)];
+    PieceType onTarget = squares[move.startSquare].type;
+    if (move.isPromotion) {
+        gain[0] += pieceValues[static_cast<int>(move.promotionType)] - pieceValues[static_cast<int>(PieceType::PAWN)];
+        onTarget = move.promotionType;
+    }
+    occupied[move.startSquare] = false;
+    if (move.isEnPassant) {
+        occupied[target + (squares[move.startSquare].color == Color::WHITE ? -8 : 8)] = false;
+    }
+
+    Color side = (squares[move.startSquare].color == Color::WHITE) ? Color::BLACK : Color::WHITE;
+    while (d < 31) {
+        int from = leastValuableAttacker(target, side, occupied);
+        if (from == -1) break;
+        Color other = (side == Color::WHITE) ? Color::BLACK : Color::WHITE;
+        if (squares[from].type == PieceType::KING) {
+            // The king may only take last: it can't capture into an attack.
+            occupied[from] = false;
+            bool defended = leastValuableAttacker(target, other, occupied) != -1;
+            occupied[from] = true;
+            if (defended) break;
+        }
+
+        d++;
+        gain[d] = pieceValues[static_cast<int>(onTarget)] - gain[d - 1];
+        onTarget = squares[from].type;
+        occupied[from] = false;
+        side = other;
+    }
+
+    // Each side may stop capturing whenever that is better for it.
+    for (; d > 0; d--) {
+        gain[d - 1] = -std::max(-gain[d - 1], gain[d]);
+    }
+    return gain[0];
+}
+
+bool Board::see_ge(const Move& move, int threshold) const {
+    return see(move) >= threshold;
+}
+
 // --- isKingInCheck Implementation ---
 bool Board::isKingInCheck(Color side) {
     // Use precomputed king position instead of searching
@@ -439,6 +555,12 @@ void Board::makeMove(const Move& move) {
     int prevEnPassantTarget = enPassantTarget;
     int prevHalfMoveClock = halfMoveClock;
     int prevFullMoveNumber= fullMoveNumber;
+    uint64_t prevZobristKey = zobristKey;
+    uint64_t prevPawnKey = pawnKey;
+
+    // Take the old castling/en passant state out of the key; the new state
+    // is XORed back in once the move has been applied.
+    zobristKey ^= castleAndEnPassantKey();
 
     // Reset half-move clock on pawn moves or captures
     halfMoveClock = (piece.type == PieceType::PAWN || move.isCapture) ? 0 : halfMoveClock + 1;
@@ -502,6 +624,16 @@ void Board::makeMove(const Move& move) {
     }
 
     // Move the piece
+    zobristKey ^= pieceKey(move.startSquare, piece);
+    if (piece.type == PieceType::PAWN) {
+        pawnKey ^= pieceKey(move.startSquare, piece);
+    }
+    if (capturedPiece.type != PieceType::NONE) {
+        zobristKey ^= pieceKey(move.targetSquare, capturedPiece);
+        if (capturedPiece.type == PieceType::PAWN) {
+            pawnKey ^= pieceKey(move.targetSquare, capturedPiece);
+        }
+    }
     squares[move.startSquare] = emptySquare;
     if (move.isPromotion) {
         // Validate promotion type
@@ -517,6 +649,10 @@ void Board::makeMove(const Move& move) {
     } else {
         squares[move.targetSquare] = piece;
     }
+    zobristKey ^= pieceKey(move.targetSquare, squares[move.targetSquare]);
+    if (squares[move.targetSquare].type == PieceType::PAWN) {
+        pawnKey ^= pieceKey(move.targetSquare, squares[move.targetSquare]);
+    }
 
     // Add piece to new position in piece list
     friendlyPieces.push_back(move.targetSquare);
@@ -533,6 +669,8 @@ void Board::makeMove(const Move& move) {
     // Handle En Passant Capture
     if (move.isEnPassant) {
         int capturedPawnSquare = move.targetSquare + ((piece.color == Color::WHITE) ? -8 : 8);
+        zobristKey ^= pieceKey(capturedPawnSquare, squares[capturedPawnSquare]);
+        pawnKey ^= pieceKey(capturedPawnSquare, squares[capturedPawnSquare]);
         squares[capturedPawnSquare] = emptySquare; // Remove the captured pawn
 
         // Remove en passant captured pawn from piece list
@@ -545,6 +683,17 @@ void Board::makeMove(const Move& move) {
 
     // Handle Castling Move
     if (move.isCastling) {
+        const Piece rook = {PieceType::ROOK, piece.color};
+        if (move.targetSquare == G1) {
+            zobristKey ^= pieceKey(H1, rook) ^ pieceKey(F1, rook);
+        } else if (move.targetSquare == C1) {
+            zobristKey ^= pieceKey(A1, rook) ^ pieceKey(D1, rook);
+        } else if (move.targetSquare == G8) {
+            zobristKey ^= pieceKey(H8, rook) ^ pieceKey(F8, rook);
+        } else if (move.targetSquare == C8) {
+            zobristKey ^= pieceKey(A8, rook) ^ pieceKey(D8, rook);
+        }
+
         if (move.targetSquare == G1) { // White kingside
             squares[F1] = squares[H1];
             squares[H1] = emptySquare;
@@ -576,16 +725,42 @@ void Board::makeMove(const Move& move) {
     if (turn == Color::BLACK){
         fullMoveNumber++;}
     turn = (turn == Color::WHITE) ? Color::BLACK : Color::WHITE;
-    positionHistory.push_back(computeZobristHash());
+    zobristKey ^= initZobrist.blackToMove ^ castleAndEnPassantKey();
+    positionHistory.push_back(zobristKey);
 
     // Store move history for undoing
     moveStack.emplace_back(
         piece, capturedPiece, move.startSquare, move.targetSquare,
         move.isEnPassant, move.isCastling, move.isPromotion, move.promotionType,
-        prevCastleRights, prevEnPassantTarget, prevHalfMoveClock,prevFullMoveNumber
+        prevCastleRights, prevEnPassantTarget, prevHalfMoveClock,prevFullMoveNumber,
+        prevZobristKey, prevPawnKey
     );
 }
 
+void Board::makeNullMove() {
+    nullMoveStack.push_back({enPassantTarget, halfMoveClock, zobristKey, positionHistory.size()});
+
+    // The en passant right lapses when the side to move passes.
+    zobristKey ^= castleAndEnPassantKey();
+    enPassantTarget = -1;
+    halfMoveClock++;
+    turn = (turn == Color::WHITE) ? Color::BLACK : Color::WHITE;
+    zobristKey ^= initZobrist.blackToMove ^ castleAndEnPassantKey();
+    positionHistory.push_back(zobristKey);
+}
+
+void Board::unmakeNullMove() {
+    if (nullMoveStack.empty()) return;
+
+    const NullMoveUndo& undo = nullMoveStack.back();
+    enPassantTarget = undo.prevEnPassantTarget;
+    halfMoveClock = undo.prevHalfMoveClock;
+    zobristKey = undo.prevZobristKey;
+    turn = (turn == Color::WHITE) ? Color::BLACK : Color::WHITE;
+    nullMoveStack.pop_back();
+    positionHistory.pop_back();
+}
+
 // Unmake move (undoes last move)
 void Board::unMakeMove() {
     if (moveStack.empty()) return;
@@ -600,6 +775,8 @@ void Board::unMakeMove() {
     halfMoveClock = lastmove.prevHalfMoveClock;
     castleRights = lastmove.prevCastleRights;
     fullMoveNumber = lastmove.prevFullMoveNumber;
+    zobristKey = lastmove.prevZobristKey;
+    pawnKey = lastmove.prevPawnKey;
 
     // Undo En Passant Capture
     if (lastmove.wasEnPassant) {
@@ -4,14 +4,22 @@
 #include <array>
 #include "types.h" // Use common types instead of including board.h
 
+// A default-constructed Move (a1a1) is the "no move" value.
 struct Move {
-    int startSquare;
-    int targetSquare;
-    bool isCapture;
-    bool isPromotion;
-    bool isEnPassant;
-    bool isCastling;
-    PieceType promotionType;
+    int startSquare = 0;
+    int targetSquare = 0;
+    bool isCapture = false;
+    bool isPromotion = false;
+    bool isEnPassant = false;
+    bool isCastling = false;
+    PieceType promotionType = PieceType::NONE;
+
+    bool isNone() const { return startSquare == targetSquare; }
+    // Same move, ignoring the flags (which are derived from the position).
+    bool sameAs(const Move& other) const {
+        return startSquare == other.startSquare && targetSquare == other.targetSquare &&
+               promotionType == other.promotionType;
+    }
 };
 struct lastMove{
     // captured piece type, previous castling rights, previous en passant square, half-move clock
@@ -29,6 +37,8 @@ struct lastMove{
     int prevEnPassantTarget;
     int prevHalfMoveClock;
     int prevFullMoveNumber;
+    uint64_t prevZobristKey;
+    uint64_t prevPawnKey;
     bool operator==(const lastMove& other) const {
         return movedPiece == other.movedPiece &&
                capturedPiece == other.capturedPiece &&
@@ -45,7 +55,8 @@ struct lastMove{
 
     lastMove(const Piece &movedPiece, const Piece &capturedPiece, int fromSquare, int toSquare,
         bool wasEnPassant, bool wasCastling, bool wasPromotion, PieceType promotedPiece,
-        const std::array<bool, 4>& prevCastleRights, int prevEnPassantTarget, int prevHalfMoveClock,int prevFullMoveNumber)
+        const std::array<bool, 4>& prevCastleRights, int prevEnPassantTarget, int prevHalfMoveClock,int prevFullMoveNumber,
+        uint64_t prevZobristKey, uint64_t prevPawnKey)
    : movedPiece(movedPiece),
      capturedPiece(capturedPiece),
      fromSquare(fromSquare),
@@ -57,7 +68,9 @@ struct lastMove{
      prevCastleRights(prevCastleRights),
      prevEnPassantTarget(prevEnPassantTarget),
      prevHalfMoveClock(prevHalfMoveClock),
-     prevFullMoveNumber(prevFullMoveNumber)
+     prevFullMoveNumber(prevFullMoveNumber),
+     prevZobristKey(prevZobristKey),
+     prevPawnKey(prevPawnKey)
 {}
 };
 #endif // MOVEGENERATOR_H
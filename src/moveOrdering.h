@@ -6,29 +6,30 @@
 #include "eval.h"
 #include <vector>
 #include <algorithm>
+#include <cstdlib>
 
-// Killer move table (2 killers per depth, max depth 64)
-constexpr int MAX_KILLER_DEPTH = 64;
+// Killer move table (2 killers per ply from the root)
+constexpr int MAX_KILLER_DEPTH = MAX_PLY;
 struct KillerMoves {
     Move killers[MAX_KILLER_DEPTH][2];
 
-    void addKiller(int depth, const Move& move) {
+    void addKiller(int ply, const Move& move) {
         // Don't store captures as killers
         if (move.isCapture) return;
 
         // Shift killers: killer[1] = killer[0], killer[0] = new
-        if (!(killers[depth][0].startSquare == move.startSquare &&
-              killers[depth][0].targetSquare == move.targetSquare)) {
-            killers[depth][1] = killers[depth][0];
-            killers[depth][0] = move;
+        if (!(killers[ply][0].startSquare == move.startSquare &&
+              killers[ply][0].targetSquare == move.targetSquare)) {
+            killers[ply][1] = killers[ply][0];
+            killers[ply][0] = move;
         }
     }
 
-    bool isKiller(int depth, const Move& move) const {
-        return (killers[depth][0].startSquare == move.startSquare &&
-                killers[depth][0].targetSquare == move.targetSquare) ||
-               (killers[depth][1].startSquare == move.startSquare &&
-                killers[depth][1].targetSquare == move.targetSquare);
+    bool isKiller(int ply, const Move& move) const {
+        return (killers[ply][0].startSquare == move.startSquare &&
+                killers[ply][0].targetSquare == move.targetSquare) ||
+               (killers[ply][1].startSquare == move.startSquare &&
+                killers[ply][1].targetSquare == move.targetSquare);
     }
 
     void clear() {
@@ -39,6 +40,87 @@ struct KillerMoves {
     }
 };
 
+// 0-11 index of a colored piece (white pawn .. black king) for the
+// piece-indexed tables below.
+constexpr int PIECE_INDEX_COUNT = 12;
+inline int pieceIndex(const Piece& piece) {
+    return static_cast<int>(piece.type) + (piece.color == Color::BLACK ? 6 : 0);
+}
+
+// History scores stay within +-MAX_HISTORY: each update moves an entry by
+// bonus scaled down as the entry approaches the limit ("gravity"), so old
+// information fades instead of saturating.
+constexpr int MAX_HISTORY = 16384;
+inline void updateHistory(int& entry, int bonus) {
+    entry += bonus - entry * std::abs(bonus) / MAX_HISTORY;
+}
+
+// Bonus for a quiet move that caused a cutoff at this depth; the quiets
+// searched before it get the same amount as a malus.
+inline int historyBonus(int depth) {
+    return std::min(32 * depth * depth, 1536);
+}
+
+// Butterfly history: how often a quiet move (side, from, to) cut off.
+struct ButterflyHistory {
+    int table[2][64][64];
+
+    int& at(Color side, const Move& move) {
+        return table[static_cast<int>(side)][move.startSquare][move.targetSquare];
+    }
+    int get(Color side, const Move& move) const {
+        return table[static_cast<int>(side)][move.startSquare][move.targetSquare];
+    }
+    void clear() {
+        std::fill(&table[0][0][0], &table[0][0][0] + 2 * 64 * 64, 0);
+    }
+};
+
+// History of (piece, destination) pairs, as a follow-up to one fixed move.
+struct PieceToHistory {
+    int table[PIECE_INDEX_COUNT][64];
+};
+
+// Continuation history: for the move played one (or two) plies earlier,
+// identified by its piece and destination, which (piece, destination)
+// replies worked. The same table serves both distances.
+struct ContinuationHistory {
+    std::vector<PieceToHistory> tables = std::vector<PieceToHistory>(PIECE_INDEX_COUNT * 64);
+
+    PieceToHistory& at(int piece, int square) {
+        return tables[piece * 64 + square];
+    }
+    void clear() {
+        std::fill(tables.begin(), tables.end(), PieceToHistory{});
+    }
+};
+
+// Countermove: the quiet reply that last refuted (piece, destination).
+struct CounterMoves {
+    Move table[PIECE_INDEX_COUNT][64];
+
+    void clear() {
+        std::fill(&table[0][0], &table[0][0] + PIECE_INDEX_COUNT * 64, Move{});
+    }
+};
+
+// What orderMoves() needs to rank quiet moves at one node.
+struct QuietOrdering {
+    const ButterflyHistory* history = nullptr;
+    Color side = Color::WHITE;
+    // Continuation tables for the moves 1 and 2 plies back (null if none).
+    const PieceToHistory* continuation[2] = {nullptr, nullptr};
+    Move counterMove;
+
+    int historyScore(const Move& move, int piece) const {
+        int score = history ? history->get(side, move) : 0;
+        for (const PieceToHistory* cont : continuation) {
+            if (cont) score += cont->table[piece][move.targetSquare];
+        }
+        return score;
+    }
+};
+
 // MVV-LVA (Most Valuable Victim - Least Valuable Attacker) scoring
 inline int getMVVLVAScore(const Move& move, const Board& board) {
     if (!move.isCapture) return 0;
@@ -58,15 +140,16 @@ inline int getMVVLVAScore(const Move& move, const Board& board) {
 
 // Move scoring for ordering
 inline int scoreMove(const Move& move, const Board& board, const Move& ttMove,
-                     const KillerMoves& killers, int depth) {
+                     const KillerMoves& killers, int ply, const QuietOrdering& quiet) {
     // 1. Transposition table move (highest priority)
     if (ttMove.startSquare == move.startSquare && ttMove.targetSquare == move.targetSquare) {
         return 1000000;
     }
 
-    // 2. Captures (MVV-LVA)
+    // 2. Captures (MVV-LVA); those losing material by SEE go after the quiets
     if (move.isCapture) {
-        return 900000 + getMVVLVAScore(move, board);
+        int base = board.see_ge(move, 0) ? 900000 : -100000;
+        return base + getMVVLVAScore(move, board);
     }
 
     // 3. Promotions
@@ -80,28 +163,34 @@ inline int scoreMove(const Move& move, const Board& board, const Move& ttMove,
     }
 
     // 4. Killer moves (good quiet moves from sibling nodes)
-    if (killers.isKiller(depth, move)) {
+    if (killers.isKiller(ply, move)) {
         return 500000;
     }
 
-    // 5. Castling
+    // 5. Countermove to the opponent's last move
+    if (move.sameAs(quiet.counterMove)) {
+        return 450000;
+    }
+
+    // 6. Castling
     if (move.isCastling) {
         return 400000;
     }
 
-    // 6. Other quiet moves (lowest priority)
-    return 0;
+    // 7. Other quiet moves, by history (bounded well below the above)
+    return quiet.historyScore(move, pieceIndex(board.squares[move.startSquare]));
 }
 
 // Order moves for alpha-beta search
 inline void orderMoves(std::vector<Move>& moves, const Board& board,
-                      const Move& ttMove, const KillerMoves& killers, int depth) {
+                      const Move& ttMove, const KillerMoves& killers, int ply,
+                      const QuietOrdering& quiet = QuietOrdering{}) {
     // Create a vector of (score, move) pairs
     std::vector<std::pair<int, Move>> scoredMoves;
     scoredMoves.reserve(moves.size());
 
     for (const auto& move : moves) {
-        int score = scoreMove(move, board, ttMove, killers, depth);
+        int score = scoreMove(move, board, ttMove, killers, ply, quiet);
         scoredMoves.emplace_back(score, move);
     }
 
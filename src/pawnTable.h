@@ -0,0 +1,50 @@
+#ifndef PAWN_TABLE_H
+#define PAWN_TABLE_H
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+#include "types.h"
+
+// Everything the evaluation derives from pawn placement alone.
+struct PawnEntry {
+    uint64_t key = 0;
+    int score = 0;                // Pawn structure score, White's point of view
+    uint64_t passed[2] = {0, 0};  // Passed pawns, indexed by Color (WHITE, BLACK)
+    int shelter[2][3] = {};       // Pawn shield per king wing: a-c, d-e, f-h
+};
+
+// Direct-mapped cache of pawn structure evaluations keyed by Board's pawn
+// Zobrist key. Pawn placement changes rarely, so nearly every probe hits.
+// A position without pawns has key 0, which matches the zeroed empty slot,
+// and that is exactly the right (empty) entry for it.
+class PawnTable {
+private:
+    std::vector<PawnEntry> table;
+    size_t mask;
+
+public:
+    // Counted since the last resetStats(); TT_STATS builds only.
+    uint64_t probes = 0;
+    uint64_t hits = 0;
+
+    explicit PawnTable(size_t entries = 16384) : table(entries), mask(entries - 1) {}
+
+    // Returns the slot for key; found is true if it already holds key.
+    PawnEntry& probe(uint64_t key, bool& found) {
+        PawnEntry& entry = table[key & mask];
+        found = entry.key == key;
+#if TT_STATS
+        probes++;
+        if (found) hits++;
+#endif
+        return entry;
+    }
+
+    void resetStats() {
+        probes = 0;
+        hits = 0;
+    }
+};
+
+#endif // PAWN_TABLE_H
@@ -4,88 +4,136 @@
 #include "board.h"
 #include "moveGenerator.h"
 #include "eval.h"
+#include "moveOrdering.h"
+#include "search.h"
+#include "transposition.h"
 #include <vector>
 #include <algorithm>
 
-// Generate only capture moves for quiescence search
-inline void generateCaptures(Board& board, std::vector<Move>& captures) {
-    captures.clear();
-    std::vector<Move> allMoves;
-    board.generateMoves(allMoves);
-
-    // Filter for captures and promotions
-    for (const auto& move : allMoves) {
-        if (move.isCapture || move.isPromotion) {
-            captures.push_back(move);
-        }
-    }
-}
+// Margin added to the captured piece's value in per-move delta pruning.
+constexpr int DELTA_MARGIN = 200;
 
 // Quiescence search - search until position is "quiet" (no captures)
-inline int quiescence(Board& board, int alpha, int beta, size_t& nodesSearched, int depth = 0) {
-    nodesSearched++;
+// pvNode is true when called from a PV node of the main search; the
+// per-move delta pruning below is only applied off the PV. The node is
+// probed and stored in state.tt like a main search node, at depth
+// QS_DEPTH_EVASIONS when in check (every move is searched) and
+// QS_DEPTH_CAPTURES otherwise; ply is the distance from the root. Nodes
+// count towards state.nodes and poll the stop conditions like the main
+// search; once stopped the result is void.
+constexpr int QS_DEPTH_EVASIONS = 0;
+constexpr int QS_DEPTH_CAPTURES = -1;
+
+inline int quiescence(Board& board, SearchState& state, int alpha, int beta, int depth = 0,
+                      bool pvNode = false, int ply = 0) {
+    state.nodes++;
+    if (state.pollStop()) {
+        return 0;
+    }
 
     // Limit quiescence search depth to prevent explosion
     constexpr int MAX_Q_DEPTH = 10;
-    if (depth >= MAX_Q_DEPTH) {
+    if (depth >= MAX_Q_DEPTH || ply >= MAX_PLY - 1) {
         return heuristic(board);
     }
+    if (board.isDraw(ply)) {
+        return 0;
+    }
+    // A move back into an earlier position of this line secures a draw
+    if (alpha < 0 && board.hasUpcomingRepetition(ply)) {
+        alpha = 0;
+        if (alpha >= beta) {
+            return alpha;
+        }
+    }
 
-    // Stand-pat score: evaluate current position
-    int standPat = heuristic(board);
-
-    // Beta cutoff: position is too good for opponent
-    if (standPat >= beta) {
-        return beta;
+    // In check there is no standing pat: every evasion is searched, and
+    // having none is mate.
+    const bool inCheck = board.isKingInCheck(board.turn);
+    const int ttDepth = inCheck ? QS_DEPTH_EVASIONS : QS_DEPTH_CAPTURES;
+    const uint64_t zobristKey = board.getZobristHash();
+    TranspositionTable& tt = state.tt;
+    Move ttMove;
+    int ttScore;
+    if (tt.probe(zobristKey, ttDepth, alpha, beta, ttScore, ttMove, ply)) {
+        return ttScore;
     }
 
-    // Delta pruning: if we're too far behind even after capturing a queen, prune
-    constexpr int DELTA_MARGIN = 1200;  // Queen value + safety margin
-    if (standPat + DELTA_MARGIN < alpha) {
-        return alpha;
+    const int originalAlpha = alpha;
+
+    // Stand-pat score: evaluate current position. Most nodes cut here, so
+    // this comes before move generation.
+    int standPat = NEG_INF;
+    if (!inCheck) {
+        standPat = heuristic(board);
+
+        // Beta cutoff: position is too good for opponent
+        if (standPat >= beta) {
+            return beta;
+        }
+        if (standPat > alpha) {
+            alpha = standPat;
+        }
     }
 
-    // Update alpha
-    if (standPat > alpha) {
-        alpha = standPat;
+    std::vector<Move> moves;
+    board.generateMoves(moves);
+    if (moves.empty()) {
+        return inCheck ? -CHECKMATE_SCORE + ply : 0;
     }
 
-    // Generate only capture moves
-    std::vector<Move> captures;
-    generateCaptures(board, captures);
+    if (!inCheck) {
+        // Only captures and promotions from here on
+        moves.erase(std::remove_if(moves.begin(), moves.end(),
+                                   [](const Move& move) { return !move.isCapture && !move.isPromotion; }),
+                    moves.end());
+    }
 
-    // Order captures by MVV-LVA (only consider good captures)
-    std::sort(captures.begin(), captures.end(), [&board](const Move& a, const Move& b) {
-        int victimA = pieceValues[static_cast<int>(board.squares[a.targetSquare].type)];
-        int victimB = pieceValues[static_cast<int>(board.squares[b.targetSquare].type)];
-        return victimA > victimB;
+    // TT move first, then MVV-LVA
+    std::sort(moves.begin(), moves.end(), [&](const Move& a, const Move& b) {
+        bool aIsTT = a.sameAs(ttMove), bIsTT = b.sameAs(ttMove);
+        if (aIsTT != bIsTT) return aIsTT;
+        return getMVVLVAScore(a, board) > getMVVLVAScore(b, board);
     });
 
-    // Search captures
-    for (const auto& move : captures) {
-        // SEE (Static Exchange Evaluation) pruning: skip obviously bad captures
-        PieceType victim = board.squares[move.targetSquare].type;
-        PieceType attacker = board.squares[move.startSquare].type;
-        int victimValue = pieceValues[static_cast<int>(victim)];
-        int attackerValue = pieceValues[static_cast<int>(attacker)];
-
-        // Skip captures where we lose material (QxP is ok, but PxQ should be considered)
-        if (victimValue < attackerValue - 200 && !move.isPromotion) {
-            continue;  // Skip bad captures like QxP when P is defended
+    Move bestMove;
+    for (const auto& move : moves) {
+        if (!inCheck && !move.isPromotion) {
+            // Delta pruning: even winning the captured piece outright
+            // (plus a margin for positional gains) stays below alpha
+            if (!pvNode) {
+                PieceType victim = move.isEnPassant ? PieceType::PAWN : board.squares[move.targetSquare].type;
+                if (standPat + pieceValues[static_cast<int>(victim)] + DELTA_MARGIN <= alpha) {
+                    continue;
+                }
+            }
+
+            // SEE pruning: skip captures that lose material once all
+            // recaptures on the square are played out
+            if (!board.see_ge(move, 0)) {
+                continue;
+            }
         }
 
         board.makeMove(move);
-        int score = -quiescence(board, -beta, -alpha, nodesSearched, depth + 1);
+        int score = -quiescence(board, state, -beta, -alpha, depth + 1, pvNode, ply + 1);
         board.unMakeMove();
+        if (state.stopped) {
+            return 0;
+        }
 
         if (score >= beta) {
+            tt.store(zobristKey, beta, ttDepth, TTFlag::LOWERBOUND, move, ply);
             return beta;
         }
         if (score > alpha) {
             alpha = score;
+            bestMove = move;
         }
     }
 
+    TTFlag flag = alpha > originalAlpha ? TTFlag::EXACT : TTFlag::UPPERBOUND;
+    tt.store(zobristKey, alpha, ttDepth, flag, bestMove, ply);
     return alpha;
 }
 
@@ -5,6 +5,8 @@
 #include "transposition.h"
 #include "moveOrdering.h"
 #include "quiescence.h"
+#include <algorithm>
+#include <cmath>
 #include <vector>
 
 
@@ -69,56 +71,456 @@ std::pair<int, Move> AlphaBeta(Board& board, int depth, int alpha, int beta,size
     return {alpha, bestMove};
 }
 
+// Null-move pruning: depth reduction R is 2, or 3 above this depth.
+constexpr int NULL_MOVE_MIN_DEPTH = 3;
+constexpr int NULL_MOVE_DEEP_REDUCTION_DEPTH = 7;
+// From this depth on a null-move cutoff is confirmed by a reduced search of
+// the real moves, which catches the zugzwangs the material guard misses.
+// Set above MAX_SEARCH_DEPTH to disable verification.
+constexpr int NULL_MOVE_VERIFICATION_DEPTH = 8;
+
+// Deepest remaining depth the static-eval pruning is applied at.
+constexpr int REVERSE_FUTILITY_MAX_DEPTH = 3;
+constexpr int FUTILITY_MAX_DEPTH = 2;
+constexpr int RAZORING_MAX_DEPTH = 2;
+
+// SEE pruning of quiet moves: skip those that lose more than
+// QUIET_SEE_MARGIN * depth in the exchange on their target square.
+constexpr int QUIET_SEE_MAX_DEPTH = 8;
+constexpr int QUIET_SEE_MARGIN = 30;
+
+// ProbCut: from this depth, captures are tried against beta + margin with
+// a search this many plies shallower.
+constexpr int PROBCUT_MIN_DEPTH = 5;
+constexpr int PROBCUT_REDUCTION = 4;
+
+// Singular extensions: from this depth, a TT move whose lower bound is
+// at most SINGULAR_TT_DEPTH_MARGIN plies shallower is tested against the
+// other moves at half depth, SINGULAR_MARGIN centipawns per ply below it.
+constexpr int SINGULAR_MIN_DEPTH = 8;
+constexpr int SINGULAR_TT_DEPTH_MARGIN = 3;
+constexpr int SINGULAR_MARGIN = 12;
+
+// Internal iterative reductions apply from this remaining depth on.
+constexpr int IIR_MIN_DEPTH = 3;
+
+// Late move reductions: quiet moves this far down the ordered list are
+// first searched shallower, by an amount growing with log(depth) *
+// log(moveNumber).
+constexpr int LMR_MIN_DEPTH = 3;
+constexpr int LMR_MIN_MOVE_NUMBER = 4;  // 1-based; earlier moves are never reduced
+constexpr int LMR_TABLE_SIZE = 64;
+
+struct ReductionTable {
+    int table[LMR_TABLE_SIZE][LMR_TABLE_SIZE] = {};
+
+    ReductionTable() {
+        for (int depth = 1; depth < LMR_TABLE_SIZE; depth++) {
+            for (int moveNumber = 1; moveNumber < LMR_TABLE_SIZE; moveNumber++) {
+                table[depth][moveNumber] =
+                    static_cast<int>(0.75 + std::log(depth) * std::log(moveNumber) / 2.25);
+            }
+        }
+    }
+
+    int operator()(int depth, int moveNumber) const {
+        return table[std::min(depth, LMR_TABLE_SIZE - 1)][std::min(moveNumber, LMR_TABLE_SIZE - 1)];
+    }
+};
+
+static const ReductionTable lmrReduction;
+
+// Without pieces besides pawns and king, passing is often the best "move"
+// (zugzwang), so a null move would prove nothing.
+static bool hasNonPawnMaterial(const Board& board, Color side) {
+    const std::vector<int>& pieces = (side == Color::WHITE) ? board.whitePieces : board.blackPieces;
+    for (int square : pieces) {
+        PieceType type = board.squares[square].type;
+        if (type != PieceType::PAWN && type != PieceType::KING) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void sortRootMoves(std::vector<RootMove>& rootMoves, size_t first) {
+    std::stable_sort(rootMoves.begin() + first, rootMoves.end(), [](const RootMove& a, const RootMove& b) {
+        return a.score != b.score ? a.score > b.score : a.nodes > b.nodes;
+    });
+}
+
 // Optimized AlphaBeta with transposition table, move ordering, and quiescence search
-std::pair<int, Move> AlphaBetaOptimized(Board& board, int depth, int alpha, int beta,
-                                        size_t& nodesSearched, TranspositionTable& tt,
-                                        KillerMoves& killers, int ply) {
-    nodesSearched++;
+std::pair<int, Move> AlphaBetaOptimized(Board& board, SearchState& state, int depth,
+                                        int alpha, int beta, int ply, bool cutNode) {
+    state.nodes++;
+    state.pvLength[ply] = 0;
+    state.selDepth = std::max(state.selDepth, ply);
     Move bestMove;
+    const bool afterNullMove = state.skipNullMove;
+    state.skipNullMove = false;
+
+    if (state.pollStop()) {
+        return {0, bestMove};
+    }
+
+    // Draw by repetition, fifty-move rule or material, before anything
+    // else: the TT can't know how a position was reached.
+    if (ply > 0 && board.isDraw(ply)) {
+        return {0, bestMove};
+    }
+
+    // A PV node has an open window; everything searched with a null window
+    // (beta == alpha + 1) is only asked "better or worse than alpha?".
+    const bool pvNode = beta - alpha > 1;
+    cutNode = cutNode && !pvNode;
+    // Singular-extension search of this same position without one move:
+    // its result says nothing about the position, so it neither uses nor
+    // fills the TT, and it doesn't prune as a whole.
+    const Move excludedMove = state.stack[ply].excludedMove;
+    const bool excluded = !excludedMove.isNone();
+    const bool root = ply == 0;
+    if (root) {
+        state.rootDepth = depth;
+    }
+    // A later MultiPV line skips the better root moves, so like an
+    // exclusion search its result is not stored.
+    const bool storeResult = !excluded && !(root && state.pvIndex > 0);
+
+    // Mate distance pruning: even mating right here can't beat a shorter
+    // mate already found, and being mated here can't be worse than alpha.
+    if (ply > 0) {
+        alpha = std::max(alpha, -CHECKMATE_SCORE + ply);
+        beta = std::min(beta, CHECKMATE_SCORE - ply - 1);
+        if (alpha >= beta) {
+            return {alpha, bestMove};
+        }
+
+        // A move back into an earlier position of this line secures at
+        // least a draw.
+        if (alpha < 0 && board.hasUpcomingRepetition(ply)) {
+            alpha = 0;
+            if (alpha >= beta) {
+                return {alpha, bestMove};
+            }
+        }
+    }
+
+    if (ply >= MAX_PLY - 1) {
+        return {heuristic(board), bestMove};
+    }
+
+    // Check extension: search forcing lines one ply deeper, which also
+    // keeps positions in check out of quiescence.
+    const bool inCheck = board.isKingInCheck(board.turn);
+    if (inCheck) {
+        depth++;
+    }
+
     uint64_t zobristKey = board.getZobristHash();
+    TranspositionTable& tt = state.tt;
 
     // Check transposition table
     int ttScore;
     Move ttMove;
-    if (tt.probe(zobristKey, depth, alpha, beta, ttScore, ttMove)) {
+    // The root never cuts off: it has to collect a PV, and a MultiPV line
+    // must not return another line's score.
+    if (root) {
+        tt.getBestMove(zobristKey, ttMove);
+    } else if (!excluded && tt.probe(zobristKey, depth, alpha, beta, ttScore, ttMove, ply)) {
         return {ttScore, ttMove};
     }
 
     // At leaf nodes, use quiescence search instead of static eval
     if (depth <= 0) {
-        int qScore = quiescence(board, alpha, beta, nodesSearched);
+        int qScore = quiescence(board, state, alpha, beta, 0, pvNode, ply);
         return {qScore, bestMove};
     }
 
-    // Generate all legal moves
+    const PruningMargins& margins = state.margins;
+    // Only needed (and only meaningful) for the pruning below.
+    const bool staticPruning = !pvNode && !inCheck && !excluded;
+    const int staticEval = staticPruning ? heuristic(board) : 0;
+
+    // Reverse futility: so far above beta that no reply at this small
+    // remaining depth is likely to bring the score back down.
+    if (staticPruning && margins.reverseFutility > 0 && depth <= REVERSE_FUTILITY_MAX_DEPTH &&
+        staticEval - margins.reverseFutility * depth >= beta) {
+        return {beta, bestMove};
+    }
+
+    // Razoring: so far below alpha that only tactics could help; let
+    // quiescence check for them and trust it if it still fails low.
+    if (staticPruning && margins.razoring > 0 && depth <= RAZORING_MAX_DEPTH &&
+        staticEval + margins.razoring * depth < alpha) {
+        int qScore = quiescence(board, state, alpha, alpha + 1, 0, false, ply);
+        if (qScore <= alpha) {
+            return {alpha, bestMove};
+        }
+    }
+
+    // Null-move pruning: if passing still fails high, a real move would
+    // too. Only off the PV, never twice in a row, not in check and not
+    // when the side to move may be in zugzwang.
+    if (staticPruning && !afterNullMove && depth >= NULL_MOVE_MIN_DEPTH &&
+        hasNonPawnMaterial(board, board.turn) && staticEval >= beta) {
+        int R = depth >= NULL_MOVE_DEEP_REDUCTION_DEPTH ? 3 : 2;
+        state.stack[ply].move = Move{};
+        state.stack[ply].movedPiece = -1;
+        board.makeNullMove();
+        state.skipNullMove = true;
+        int nullScore = -AlphaBetaOptimized(board, state, depth - 1 - R, -beta, -beta + 1, ply + 1, !cutNode).first;
+        board.unmakeNullMove();
+        if (state.stopped) {
+            return {0, bestMove};
+        }
+
+        if (nullScore >= beta) {
+            if (depth < NULL_MOVE_VERIFICATION_DEPTH) {
+                return {beta, bestMove};
+            }
+            state.skipNullMove = true;
+            int verified = AlphaBetaOptimized(board, state, depth - R, beta - 1, beta, ply, cutNode).first;
+            if (state.stopped) {
+                return {0, bestMove};
+            }
+            if (verified >= beta) {
+                return {beta, bestMove};
+            }
+        }
+    }
+
+    // Generate all legal moves; the root reuses its persistent list,
+    // sorted by what the previous searches found.
     std::vector<Move> movesToSearch;
-    board.generateMoves(movesToSearch);
+    if (root && !state.rootMoves.empty()) {
+        sortRootMoves(state.rootMoves, state.pvIndex);
+        for (size_t i = state.pvIndex; i < state.rootMoves.size(); i++) {
+            movesToSearch.push_back(state.rootMoves[i].move);
+            state.rootMoves[i].score = NEG_INF;
+        }
+    } else {
+        board.generateMoves(movesToSearch);
+    }
 
-    // Terminal node: checkmate or stalemate
+    // Terminal node: checkmate (scored by distance from the root) or stalemate
     if (movesToSearch.empty()) {
-        int score = evaluate(board);
+        int score = inCheck ? -CHECKMATE_SCORE + ply : 0;
         return {score, bestMove};
     }
 
-    // Move ordering: TT move, captures (MVV-LVA), killers, quiet moves
-    orderMoves(movesToSearch, board, ttMove, killers, depth);
+    // ProbCut: a capture that beats beta by a clear margin in a shallow
+    // search would almost surely beat beta in the full one. The capture has
+    // to win enough material by SEE, then pass a qsearch and finally a
+    // reduced search against the raised bound.
+    if (staticPruning && margins.probCut > 0 && depth >= PROBCUT_MIN_DEPTH &&
+        !isMateScore(beta)) {
+        const int probBeta = beta + margins.probCut;
+        for (const auto& move : movesToSearch) {
+            if (!move.isCapture || !board.see_ge(move, probBeta - staticEval)) {
+                continue;
+            }
+            state.stack[ply].move = move;
+            state.stack[ply].movedPiece = pieceIndex(board.squares[move.startSquare]);
+            board.makeMove(move);
+            int value = -quiescence(board, state, -probBeta, -probBeta + 1, 0, false, ply + 1);
+            if (value >= probBeta) {
+                value = -AlphaBetaOptimized(board, state, depth - PROBCUT_REDUCTION, -probBeta, -probBeta + 1,
+                                            ply + 1, !cutNode).first;
+            }
+            board.unMakeMove();
+            if (state.stopped) {
+                return {0, bestMove};
+            }
+            if (value >= probBeta) {
+                tt.store(zobristKey, value, depth - PROBCUT_REDUCTION + 1, TTFlag::LOWERBOUND, move, ply);
+                return {beta, move};
+            }
+        }
+    }
+
+    // Still on the previous iteration's PV: search its move first.
+    if (state.followPV) {
+        state.followPV = false;
+        if (ply < static_cast<int>(state.prevPV.size())) {
+            const Move& pvMove = state.prevPV[ply];
+            for (const auto& move : movesToSearch) {
+                if (move.sameAs(pvMove)) {
+                    ttMove = move;
+                    state.followPV = true;
+                    break;
+                }
+            }
+        }
+    }
+
+    // Quiet moves are ranked by their history, and by continuation history
+    // and countermove relative to the moves played 1 and 2 plies earlier.
+    QuietOrdering quietOrdering;
+    quietOrdering.history = &state.history;
+    quietOrdering.side = board.turn;
+    PieceToHistory* continuation[2] = {nullptr, nullptr};
+    for (int back = 1; back <= 2 && back <= ply; back++) {
+        const SearchStackEntry& previous = state.stack[ply - back];
+        if (previous.movedPiece < 0) break;  // No continuation across a null move
+        continuation[back - 1] = &state.continuation.at(previous.movedPiece, previous.move.targetSquare);
+        quietOrdering.continuation[back - 1] = continuation[back - 1];
+        if (back == 1) {
+            quietOrdering.counterMove = state.counterMoves.table[previous.movedPiece][previous.move.targetSquare];
+        }
+    }
+
+    // Internal iterative reduction: without a hash move this node's
+    // ordering is guesswork, so search it a ply shallower; the result
+    // provides a hash move for the next visit.
+    if ((pvNode || cutNode) && !root && !excluded && depth >= IIR_MIN_DEPTH && ttMove.isNone()) {
+        depth--;
+    }
+
+    // Move ordering: TT move, captures (MVV-LVA), killers, countermove, quiets by history
+    if (!root || state.rootMoves.empty()) {
+        orderMoves(movesToSearch, board, ttMove, state.killers, ply, quietOrdering);
+    }
+    if (root && state.rootMoves.empty()) {
+        for (const Move& move : movesToSearch) {
+            state.rootMoves.push_back(RootMove{move});
+        }
+    }
+
+    // Singular extension: if every other move fails low against a bound a
+    // little under the TT move's score, the TT move is the only good one
+    // and gets an extra ply. If instead some other move also beats a bound
+    // that is still at or above beta, there are several cutting moves and
+    // the node is cut right away (multi-cut).
+    bool singularExtension = false;
+    TTEntry ttEntry;
+    if (!root && !excluded && depth >= SINGULAR_MIN_DEPTH && !ttMove.isNone() &&
+        ply < 2 * state.rootDepth && tt.lookup(zobristKey, ttEntry, ply) &&
+        ttEntry.bestMove.sameAs(ttMove) && ttEntry.flag != TTFlag::UPPERBOUND &&
+        ttEntry.depth >= depth - SINGULAR_TT_DEPTH_MARGIN && !isMateScore(ttEntry.score)) {
+        const int singularBeta = ttEntry.score - SINGULAR_MARGIN * depth;
+        const bool followingPV = state.followPV;
+        state.followPV = false;
+        state.stack[ply].excludedMove = ttMove;
+        int value = AlphaBetaOptimized(board, state, (depth - 1) / 2, singularBeta - 1, singularBeta, ply,
+                                       cutNode).first;
+        state.stack[ply].excludedMove = Move{};
+        state.followPV = followingPV;
+        if (state.stopped) {
+            return {0, bestMove};
+        }
+
+        if (value < singularBeta) {
+            singularExtension = true;
+        } else if (singularBeta >= beta) {
+            return {beta, ttMove};
+        }
+    }
 
-    int originalAlpha = alpha;
     TTFlag ttFlag = TTFlag::UPPERBOUND;
 
-    // Search all moves
+    // Futility pruning: quiet moves can't lift a hopeless eval to alpha
+    // within the last ply or two.
+    const bool futile = !pvNode && !inCheck && margins.futility > 0 && depth <= FUTILITY_MAX_DEPTH &&
+                        staticEval + margins.futility * depth <= alpha;
+
+    // Principal variation search: the first (best-ordered) move gets the
+    // full window; the rest only have to prove they are no better than it
+    // with a null window, and are re-searched in full if they are. Late
+    // quiet moves take that null-window test at reduced depth first.
+    int moveNumber = 0;
+    std::vector<std::pair<Move, int>> quietsSearched;  // (move, piece), for the history malus
     for (const auto& move : movesToSearch) {
+        if (excluded && move.sameAs(excludedMove)) {
+            continue;
+        }
+        moveNumber++;
+        const size_t nodesBefore = state.nodes;
+        if (root && state.onRootMove) {
+            state.onRootMove(state.rootDepth, move, moveNumber);
+        }
+        const int movedPiece = pieceIndex(board.squares[move.startSquare]);
+        const bool quietMove = !move.isCapture && !move.isPromotion;
+        const int newDepth = depth - 1 + (singularExtension && move.sameAs(ttMove) ? 1 : 0);
+        // SEE has to look at the position before the move.
+        const bool losesExchange = !pvNode && !inCheck && quietMove && moveNumber > 1 &&
+                                   depth <= QUIET_SEE_MAX_DEPTH &&
+                                   !board.see_ge(move, -QUIET_SEE_MARGIN * depth);
+        state.stack[ply].move = move;
+        state.stack[ply].movedPiece = movedPiece;
         board.makeMove(move);
-        int val = -AlphaBetaOptimized(board, depth - 1, -beta, -alpha, nodesSearched, tt, killers, ply + 1).first;
+        const bool quiet = quietMove && !board.isKingInCheck(board.turn);
+        if (quiet && moveNumber > 1 && (futile || losesExchange)) {
+            board.unMakeMove();
+            continue;
+        }
+
+        int val;
+        if (moveNumber == 1) {
+            val = -AlphaBetaOptimized(board, state, newDepth, -beta, -alpha, ply + 1, !cutNode).first;
+        } else {
+            int reduction = 0;
+            if (depth >= LMR_MIN_DEPTH && moveNumber >= LMR_MIN_MOVE_NUMBER && !inCheck && quiet) {
+                reduction = lmrReduction(depth, moveNumber);
+                if (pvNode) reduction--;
+                if (state.killers.isKiller(ply, move)) reduction--;
+                // One ply less for a strongly positive history, one more for a strongly negative one.
+                reduction -= quietOrdering.historyScore(move, movedPiece) / 16000;
+                // Always leave at least one ply of real search.
+                reduction = std::clamp(reduction, 0, depth - 2);
+            }
+
+            val = -AlphaBetaOptimized(board, state, newDepth - reduction, -alpha - 1, -alpha, ply + 1,
+                                      !cutNode).first;
+            if (reduction > 0 && val > alpha && !state.stopped) {
+                val = -AlphaBetaOptimized(board, state, newDepth, -alpha - 1, -alpha, ply + 1, !cutNode).first;
+            }
+            if (pvNode && val > alpha && val < beta && !state.stopped) {
+                val = -AlphaBetaOptimized(board, state, newDepth, -beta, -alpha, ply + 1).first;
+            }
+        }
         board.unMakeMove();
 
+        // Aborted: the score is meaningless, so store nothing.
+        if (state.stopped) {
+            return {0, bestMove};
+        }
+
+        if (root) {
+            for (RootMove& rootMove : state.rootMoves) {
+                if (rootMove.move.sameAs(move)) {
+                    rootMove.score = val > alpha ? val : NEG_INF;
+                    rootMove.nodes = state.nodes - nodesBefore;
+                    break;
+                }
+            }
+        }
+
         // Beta cutoff (fail-high)
         if (val >= beta) {
-            // Store killer move
-            killers.addKiller(ply, move);
+            // Reward the quiet move that cut off, punish the ones tried before it
+            if (quietMove) {
+                state.killers.addKiller(ply, move);
+                int bonus = historyBonus(depth);
+                auto reward = [&](const Move& quiet, int piece, int amount) {
+                    updateHistory(state.history.at(board.turn, quiet), amount);
+                    for (PieceToHistory* cont : continuation) {
+                        if (cont) updateHistory(cont->table[piece][quiet.targetSquare], amount);
+                    }
+                };
+                reward(move, movedPiece, bonus);
+                for (const auto& [quiet, piece] : quietsSearched) {
+                    reward(quiet, piece, -bonus);
+                }
+                if (ply > 0 && state.stack[ply - 1].movedPiece >= 0) {
+                    const SearchStackEntry& previous = state.stack[ply - 1];
+                    state.counterMoves.table[previous.movedPiece][previous.move.targetSquare] = move;
+                }
+            }
 
             // Store in transposition table
-            tt.store(zobristKey, beta, depth, TTFlag::LOWERBOUND, move);
+            if (storeResult) {
+                tt.store(zobristKey, beta, depth, TTFlag::LOWERBOUND, move, ply);
+            }
             return {beta, move};
         }
 
@@ -127,11 +529,33 @@ std::pair<int, Move> AlphaBetaOptimized(Board& board, int depth, int alpha, int
             alpha = val;
             bestMove = move;
             ttFlag = TTFlag::EXACT;
+            if (pvNode) {
+                state.pvTable[ply][0] = move;
+                std::copy_n(state.pvTable[ply + 1].begin(), state.pvLength[ply + 1], state.pvTable[ply].begin() + 1);
+                state.pvLength[ply] = 1 + state.pvLength[ply + 1];
+            }
+        }
+        if (quietMove) {
+            quietsSearched.emplace_back(move, movedPiece);
         }
     }
 
     // Store in transposition table
-    tt.store(zobristKey, alpha, depth, ttFlag, bestMove);
+    if (storeResult) {
+        tt.store(zobristKey, alpha, depth, ttFlag, bestMove, ply);
+    }
 
     return {alpha, bestMove};
 }
+
+std::pair<int, Move> AlphaBetaOptimized(Board& board, int depth, int alpha, int beta,
+                                        size_t& nodesSearched, TranspositionTable& tt,
+                                        KillerMoves& killers, int ply) {
+    SearchState state(tt);
+    state.killers = killers;
+    state.nodes = nodesSearched;
+    auto result = AlphaBetaOptimized(board, state, depth, alpha, beta, ply);
+    killers = state.killers;
+    nodesSearched = state.nodes;
+    return result;
+}
@@ -3,14 +3,144 @@
 #include "board.h"
 #include "transposition.h"
 #include "moveOrdering.h"
+#include "timeManager.h"
+#include <array>
+#include <atomic>
+#include <functional>
+#include <vector>
+
+// Flags another thread (the UCI input loop) uses to steer a running search.
+struct SearchSignals {
+    std::atomic<bool> stop{false};    // Abort as soon as possible
+    std::atomic<bool> ponder{false};  // Searching on the opponent's time: ignore the clock
+};
+
+// Static-eval pruning margins near the leaves, in centipawns; 0 turns the
+// technique off. Exposed as UCI options for tuning.
+struct PruningMargins {
+    int reverseFutility = 120;  // Per ply: prune if eval - margin * depth >= beta (depth <= 3)
+    int futility = 150;         // Per ply: skip quiets if eval + margin * depth <= alpha (depth <= 2)
+    int razoring = 300;         // Per ply: drop into qsearch if eval + margin * depth < alpha (depth <= 2)
+    int probCut = 150;          // Cut if a capture beats beta + margin at reduced depth (depth >= 5)
+};
+
+// How often (in nodes) the search looks at the clock and stop signal.
+constexpr size_t TIME_CHECK_INTERVAL = 2048;
+
+// What the search is doing at one ply from the root.
+struct SearchStackEntry {
+    Move move;             // Move being searched from this ply
+    int movedPiece = -1;   // pieceIndex() of its piece; -1 for a null move
+    Move excludedMove;     // Skipped at this ply during a singular-extension search
+};
+
+// A legal move at the root with what the last search learned about it.
+// The root list is kept across iterations and re-sorted before each root
+// search: the move that scored best first, then the rest by the size of
+// their last subtree, which tracks how hard each was to refute.
+struct RootMove {
+    Move move;
+    int score = NEG_INF;  // Last exact or fail-high score; NEG_INF if it failed low
+    size_t nodes = 0;     // Nodes spent on its subtree in the last search
+};
+
+// Per-thread search state, threaded through AlphaBetaOptimized.
+struct SearchState {
+    TranspositionTable& tt;
+    size_t nodes = 0;
+    TTStats ttStats;  // This thread's TT counters for the last search (TT_STATS builds)
+
+    // Quiet move ordering, all indexed consistently by ply via stack.
+    KillerMoves killers;
+    ButterflyHistory history;
+    CounterMoves counterMoves;
+    ContinuationHistory continuation;
+    std::array<SearchStackEntry, MAX_PLY> stack;
+
+    // Principal variation of the previous iteration. While the search is
+    // still walking down this line, its move is tried first at each ply.
+    std::vector<Move> prevPV;
+    bool followPV = false;
+
+    // Triangular PV: pvTable[ply] holds the best line found from ply on,
+    // pvLength[ply] moves long, rebuilt from the child's line whenever a
+    // move raises alpha at a PV node. pvTable[0] is the root's line.
+    std::array<std::array<Move, MAX_PLY>, MAX_PLY> pvTable;
+    std::array<int, MAX_PLY> pvLength{};
+    int selDepth = 0;  // Deepest ply the main search reached
+
+    // Called at the root before each move is searched, with the root depth
+    // and the move's 1-based number.
+    std::function<void(int depth, const Move& move, int moveNumber)> onRootMove;
+
+    // Moves of the root position; filled by the first root search and
+    // cleared by the caller when the root changes.
+    std::vector<RootMove> rootMoves;
+    // MultiPV: rootMoves before this index are earlier lines' moves and
+    // are not searched.
+    size_t pvIndex = 0;
+
+    // Set just before searching the reply to a null move (or a null-move
+    // verification search), so that node doesn't try another null move.
+    bool skipNullMove = false;
+
+    // Depth of the current root search; bounds how far extensions may
+    // stretch a line.
+    int rootDepth = 0;
+
+    PruningMargins margins;
+
+    // Polled every TIME_CHECK_INTERVAL nodes: the search aborts when
+    // signals->stop is raised or timer reaches its hard limit (unless
+    // pondering). Once stopped is true every node returns immediately and
+    // results are void.
+    const TimeManager* timer = nullptr;
+    const SearchSignals* signals = nullptr;
+    bool stopped = false;
+    size_t lastTimeCheck = 0;  // nodes at the last poll
+
+    explicit SearchState(TranspositionTable& table) : tt(table) {
+        clearHistory();
+    }
+
+    // Called at every node of the main search and quiescence; returns
+    // stopped. Counts nodes since the last poll rather than testing for
+    // multiples of the interval, which both searches' increments skip past.
+    bool pollStop() {
+        if (!stopped && nodes - lastTimeCheck >= TIME_CHECK_INTERVAL) {
+            lastTimeCheck = nodes;
+            bool pondering = signals && signals->ponder.load(std::memory_order_relaxed);
+            stopped = (signals && signals->stop.load(std::memory_order_relaxed)) ||
+                      (timer && !pondering && timer->hardLimitReached());
+        }
+        return stopped;
+    }
+
+    // Forget everything learned about move ordering.
+    void clearHistory() {
+        killers.clear();
+        history.clear();
+        counterMoves.clear();
+        continuation.clear();
+    }
+};
+
+// Stable-sort rootMoves[first..] best first: scored moves by score, then
+// the rest by subtree size.
+void sortRootMoves(std::vector<RootMove>& rootMoves, size_t first = 0);
 
 // Original search functions (kept for compatibility)
 std::pair<int, Move> negaMax(Board& board,int depth);
 std::pair<int, Move> AlphaBeta(Board& board,int depth, int alpha, int beta,size_t& nodesSearched);
 
-// Optimized search with transposition table
+// Optimized search with transposition table. cutNode marks a null-window
+// node expected to fail high (the child of an expected fail-low node).
+std::pair<int, Move> AlphaBetaOptimized(Board& board, SearchState& state, int depth,
+                                        int alpha, int beta, int ply = 0, bool cutNode = false);
+
+// Single fixed-depth call with caller-owned tables (kept for compatibility)
 std::pair<int, Move> AlphaBetaOptimized(Board& board, int depth, int alpha, int beta,
                                         size_t& nodesSearched, TranspositionTable& tt,
                                         KillerMoves& killers, int ply = 0);
 
-#endif
\ No newline at end of file
+#endif
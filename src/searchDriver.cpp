@@ -0,0 +1,302 @@
+#include "searchDriver.h"
+#include "eval.h"
+#include <algorithm>
+
+namespace {
+
+// Half-width of the first aspiration window, in centipawns.
+constexpr int ASPIRATION_WINDOW = 25;
+// Shallower iterations are too unstable to benefit from a narrow window.
+constexpr int ASPIRATION_MIN_DEPTH = 4;
+
+} // namespace
+
+SearchDriver::SearchDriver(TranspositionTable& table) : tt(table) {
+    setThreadCount(1);
+}
+
+void SearchDriver::start(const Board& board, const SearchLimits& limits,
+                         IterationCallback onIteration, CompletionCallback onDone,
+                         CurrentMoveCallback onCurrentMove) {
+    pool.start(0, [this, root = board, limits, onIteration, onDone, onCurrentMove](size_t) mutable {
+        SearchResult result = mainSearch(root, limits, onIteration, onCurrentMove);
+        if (onDone) {
+            onDone(result);
+        }
+    });
+}
+
+void SearchDriver::wait() {
+    pool.wait(0);
+}
+
+SearchResult SearchDriver::search(const Board& board, const SearchLimits& limits,
+                                  const IterationCallback& onIteration) {
+    SearchResult result;
+    start(board, limits, onIteration, [&result](const SearchResult& done) { result = done; });
+    wait();
+    return result;
+}
+
+SearchResult SearchDriver::mainSearch(Board& board, const SearchLimits& limits,
+                                      const IterationCallback& onIteration,
+                                      const CurrentMoveCallback& onCurrentMove) {
+    SearchState& state = *states[0];
+    SearchResult result;
+    // Per-search cache statistics, read back by the caller from onDone.
+    threadEvalCache().resetStats();
+    threadPawnTable().resetStats();
+    TranspositionTable::resetThreadStats();
+    state.nodes = 0;
+    state.prevPV.clear();
+    state.rootMoves.clear();
+    state.selDepth = 0;
+    state.stopped = false;
+    state.lastTimeCheck = 0;
+    state.timer = nullptr;
+    state.signals = nullptr;
+    timer.start(limits.clock, board.turn);
+
+    int64_t lastCurrentMoveMs = 0;
+    state.onRootMove = nullptr;
+    if (onCurrentMove) {
+        state.onRootMove = [this, &onCurrentMove, &lastCurrentMoveMs](int depth, const Move& move, int number) {
+            int64_t now = timer.elapsedMs();
+            if (now >= CURRMOVE_DELAY_MS && now - lastCurrentMoveMs >= CURRMOVE_INTERVAL_MS) {
+                lastCurrentMoveMs = now;
+                onCurrentMove(depth, move, number);
+            }
+        };
+    }
+
+    int64_t lastIterationMs = 0;
+    int64_t prevIterationMs = 0;
+
+    int maxDepth = std::min(std::max(limits.depth, 1), MAX_SEARCH_DEPTH);
+
+    helperSignals.stop = false;
+    for (size_t i = 1; i < pool.size(); i++) {
+        pool.start(i, [this, board, maxDepth](size_t index) mutable {
+            helperSearch(board, *states[index], index, maxDepth);
+        });
+    }
+
+    for (int depth = 1; depth <= maxDepth; depth++) {
+        int64_t iterationStart = timer.elapsedMs();
+        Move previousBest = result.bestMove;
+        int previousScore = result.score;
+        // Depth 1 always completes so there is a move to play.
+        if (depth > 1) {
+            state.signals = &signals;
+            state.timer = timer.enabled() ? &timer : nullptr;
+        }
+
+        // MultiPV: line k searches the root moves not taken by lines
+        // 0..k-1, each with its own aspiration window and previous PV. The
+        // TT, history and root move order carry over between lines.
+        std::vector<PVLine> lines;
+        size_t lineCount = 1;
+        for (size_t pvIndex = 0; pvIndex < lineCount; pvIndex++) {
+            const bool havePrevious = pvIndex < result.lines.size();
+            state.pvIndex = pvIndex;
+            // Follow only the part of the line's previous PV the TT still
+            // agrees with; where an entry on it has since been overwritten,
+            // its newer move is the better guess.
+            state.prevPV.clear();
+            if (havePrevious && !result.lines[pvIndex].pv.empty()) {
+                state.prevPV = extractPV(board, {result.lines[pvIndex].pv[0]}, depth - 1);
+            }
+
+            int delta = ASPIRATION_WINDOW;
+            int alpha = NEG_INF;
+            int beta = POS_INF;
+            if (depth >= ASPIRATION_MIN_DEPTH && havePrevious) {
+                alpha = std::max(result.lines[pvIndex].score - delta, NEG_INF);
+                beta = std::min(result.lines[pvIndex].score + delta, POS_INF);
+            }
+
+            std::pair<int, Move> rootResult;
+            while (true) {
+                state.followPV = true;
+                rootResult = AlphaBetaOptimized(board, state, depth, alpha, beta);
+                int score = rootResult.first;
+                if (state.stopped) break;
+
+                // Widen only the side that failed, doubling the step each time.
+                if (score <= alpha && alpha > NEG_INF) {
+                    delta *= 2;
+                    alpha = std::max(score - delta, NEG_INF);
+                } else if (score >= beta && beta < POS_INF) {
+                    delta *= 2;
+                    beta = std::min(score + delta, POS_INF);
+                    // A fail-high move is at least as good as the old best.
+                    // The old PV answers another move, so drop it.
+                    if (pvIndex == 0 && !rootResult.second.sameAs(result.bestMove)) {
+                        result.bestMove = rootResult.second;
+                        result.pv = {result.bestMove};
+                    }
+                } else {
+                    break;
+                }
+            }
+            if (state.stopped) break;
+
+            // Bring this line's move to the front of the moves still open,
+            // so the next line starts after it.
+            sortRootMoves(state.rootMoves, pvIndex);
+
+            // The line collected by the search is completed from the TT
+            // where it stops at a TT cutoff. Helpers write the TT
+            // concurrently, so moves read back from it are only trusted
+            // once extractPV() has found them legal.
+            std::vector<Move> line(state.pvTable[0].begin(), state.pvTable[0].begin() + state.pvLength[0]);
+            if (line.empty()) {
+                line.push_back(rootResult.second);
+            }
+            lines.push_back(PVLine{rootResult.first, extractPV(board, line, depth)});
+            if (pvIndex == 0) {
+                lineCount = std::min<size_t>(std::max(limits.multiPV, 1), state.rootMoves.size());
+            }
+        }
+        state.pvIndex = 0;
+
+        // An aborted iteration is discarded; the last complete one stands.
+        if (state.stopped) {
+            result.nodes = state.nodes;
+            break;
+        }
+
+        // A later line can come back better than an earlier one, whose
+        // search saw its move only through a narrower window.
+        std::stable_sort(lines.begin(), lines.end(),
+                         [](const PVLine& a, const PVLine& b) { return a.score > b.score; });
+        result.score = lines[0].score;
+        result.depth = depth;
+        if (!lines[0].pv.empty()) {
+            result.bestMove = lines[0].pv[0];
+            result.pv = lines[0].pv;
+        } else {
+            result.pv = extractPV(board, {result.bestMove}, depth);
+            lines[0].pv = result.pv;
+        }
+        result.lines = lines;
+        result.nodes = state.nodes;
+        result.selDepth = state.selDepth;
+        result.timeMs = timer.elapsedMs();
+
+        if (onIteration) {
+            onIteration(result);
+        }
+
+        if (signals.stop.load(std::memory_order_relaxed)) {
+            break;
+        }
+        if (timer.enabled()) {
+            if (depth > 1) {
+                timer.update(!result.bestMove.sameAs(previousBest), previousScore - result.score);
+            }
+            prevIterationMs = lastIterationMs;
+            lastIterationMs = timer.elapsedMs() - iterationStart;
+            // While pondering the clock isn't ours yet; keep deepening.
+            if (!signals.ponder.load(std::memory_order_relaxed) &&
+                !timer.canStartIteration(lastIterationMs, prevIterationMs)) {
+                break;
+            }
+        }
+    }
+
+    helperSignals.stop = true;
+    state.ttStats = TranspositionTable::threadStats();
+    result.ttStats = state.ttStats;
+    for (size_t i = 1; i < pool.size(); i++) {
+        pool.wait(i);
+        result.nodes += states[i]->nodes;
+        result.ttStats += states[i]->ttStats;
+    }
+    state.onRootMove = nullptr;
+
+    return result;
+}
+
+void SearchDriver::helperSearch(Board& board, SearchState& helper, size_t helperIndex, int maxDepth) {
+    helper.nodes = 0;
+    helper.prevPV.clear();
+    helper.rootMoves.clear();
+    helper.followPV = false;
+    helper.stopped = false;
+    helper.lastTimeCheck = 0;
+    helper.timer = nullptr;
+    helper.signals = &helperSignals;
+    TranspositionTable::resetThreadStats();
+
+    // Odd helpers run one ply ahead so the threads spread over two depths
+    // instead of all repeating the main thread's iteration.
+    int startDepth = 1 + static_cast<int>(helperIndex % 2);
+    for (int depth = startDepth; depth <= maxDepth && !helper.stopped; depth++) {
+        AlphaBetaOptimized(board, helper, depth, NEG_INF, POS_INF);
+    }
+    helper.ttStats = TranspositionTable::threadStats();
+}
+
+void SearchDriver::clear() {
+    for (auto& state : states) {
+        state->clearHistory();
+        state->prevPV.clear();
+    }
+}
+
+void SearchDriver::setPruningMargins(const PruningMargins& newMargins) {
+    margins = newMargins;
+    for (auto& state : states) {
+        state->margins = margins;
+    }
+}
+
+void SearchDriver::setThreadCount(size_t count, bool pinThreads) {
+    count = std::max<size_t>(count, 1);
+    states.clear();
+    states.resize(count);
+    pool.resize(count, pinThreads);
+
+    // Allocate from the workers themselves so each thread's tables are
+    // first touched (and placed) where that thread runs.
+    pool.runOnAll([this](size_t index) {
+        states[index] = std::make_unique<SearchState>(tt);
+        states[index]->margins = margins;
+        threadEvalCache();
+        threadPawnTable();
+    });
+}
+
+std::vector<Move> SearchDriver::extractPV(Board& board, const std::vector<Move>& line, int maxLength) {
+    std::vector<Move> pv;
+    std::vector<uint64_t> seen;
+    Move next = line.empty() ? Move{} : line[0];
+
+    while (static_cast<int>(pv.size()) < maxLength && !next.isNone()) {
+        // Only follow moves that are legal here; TT entries can be stale.
+        std::vector<Move> legalMoves;
+        board.generateMoves(legalMoves);
+        auto it = std::find_if(legalMoves.begin(), legalMoves.end(),
+                               [&next](const Move& m) { return m.sameAs(next); });
+        if (it == legalMoves.end()) break;
+
+        seen.push_back(board.getZobristHash());
+        board.makeMove(*it);
+        pv.push_back(*it);
+
+        // Stop on a repeated position to avoid cycling through the TT.
+        if (std::find(seen.begin(), seen.end(), board.getZobristHash()) != seen.end()) break;
+        next = Move{};
+        if (pv.size() < line.size()) {
+            next = line[pv.size()];
+        } else {
+            tt.getBestMove(board.getZobristHash(), next);
+        }
+    }
+
+    for (size_t i = 0; i < pv.size(); i++) {
+        board.unMakeMove();
+    }
+    return pv;
+}
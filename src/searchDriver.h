@@ -0,0 +1,130 @@
+#ifndef SEARCH_DRIVER_H
+#define SEARCH_DRIVER_H
+
+#include "board.h"
+#include "search.h"
+#include "transposition.h"
+#include "timeManager.h"
+#include "threadPool.h"
+#include <functional>
+#include <memory>
+#include <vector>
+
+constexpr int MAX_SEARCH_DEPTH = 64;
+constexpr int MAX_SEARCH_THREADS = 256;
+
+// What the caller asked for.
+struct SearchLimits {
+    int depth = MAX_SEARCH_DEPTH;
+    ClockLimits clock;
+    bool infinite = false;  // Search until told to stop
+    bool ponder = false;    // Started with "go ponder"
+    int multiPV = 1;        // Number of best lines to search and report
+};
+
+// One MultiPV line.
+struct PVLine {
+    int score = 0;
+    std::vector<Move> pv;
+};
+
+// Outcome of the last completed iteration.
+struct SearchResult {
+    Move bestMove;
+    int score = 0;
+    int depth = 0;
+    size_t nodes = 0;
+    int selDepth = 0;    // Deepest ply reached
+    int64_t timeMs = 0;  // Since the search started
+    std::vector<Move> pv;
+    std::vector<PVLine> lines;  // MultiPV lines, best first; lines[0] is score/pv
+    TTStats ttStats;            // Summed over all threads (TT_STATS builds)
+};
+
+// Iterative deepening driver. Searches depth 1, 2, ... up to the limit,
+// opening each iteration with an aspiration window around the previous
+// score and trying the previous principal variation first. Root moves are
+// kept for the whole search and re-sorted by score and subtree size each
+// iteration. Killers and history tables
+// persist between searches until clear() is called.
+//
+// With more than one thread the search is Lazy SMP: helper threads run
+// their own iterative deepening on copies of the root position, half of
+// them one ply deeper, and share only the transposition table. What they
+// store there reorders and cuts the main thread's search. The result and
+// all reporting come from the main thread.
+//
+// All searching happens on a persistent ThreadPool: worker 0 is the main
+// thread, workers 1..n-1 are helpers. Each worker allocates its own
+// SearchState (and evaluation caches), so with pinning they live on the
+// worker's NUMA node.
+class SearchDriver {
+public:
+    using IterationCallback = std::function<void(const SearchResult&)>;
+    using CompletionCallback = std::function<void(const SearchResult&)>;
+    // Root move about to be searched: iteration depth, move, 1-based number.
+    using CurrentMoveCallback = std::function<void(int depth, const Move& move, int moveNumber)>;
+
+    // onCurrentMove is only called once the search has run for
+    // CURRMOVE_DELAY_MS, and then at most every CURRMOVE_INTERVAL_MS.
+    static constexpr int64_t CURRMOVE_DELAY_MS = 3000;
+    static constexpr int64_t CURRMOVE_INTERVAL_MS = 500;
+
+    explicit SearchDriver(TranspositionTable& tt);
+
+    // Written by the controlling thread: reset stop and set ponder before
+    // search() starts, raise stop / clear ponder while it runs.
+    SearchSignals signals;
+
+    // Start searching on the pool and return immediately. The callbacks are
+    // called from the main search thread.
+    void start(const Board& board, const SearchLimits& limits,
+               IterationCallback onIteration, CompletionCallback onDone,
+               CurrentMoveCallback onCurrentMove = nullptr);
+
+    // Block until the search started by start() has called onDone.
+    void wait();
+
+    // start() + wait(). Must not be called from inside a callback.
+    SearchResult search(const Board& board, const SearchLimits& limits,
+                        const IterationCallback& onIteration = nullptr);
+
+    // Forget move ordering state (e.g. on ucinewgame).
+    void clear();
+
+    // Number of search threads (at least 1). Recreates the pool, optionally
+    // pinning each thread to its own CPU. No search may be running.
+    void setThreadCount(size_t count, bool pinThreads = false);
+    size_t threadCount() const {
+        return pool.size();
+    }
+
+    // Pruning margins used by every search thread from the next search on.
+    void setPruningMargins(const PruningMargins& newMargins);
+    const PruningMargins& pruningMargins() const {
+        return margins;
+    }
+
+private:
+    TranspositionTable& tt;
+    TimeManager timer;
+    ThreadPool pool;
+    PruningMargins margins;
+
+    // One state per pool worker, each with its own killers and counters;
+    // states[0] belongs to the main thread.
+    std::vector<std::unique_ptr<SearchState>> states;
+    // Raised once the main thread is done, so the helpers stop with it.
+    SearchSignals helperSignals;
+
+    SearchResult mainSearch(Board& board, const SearchLimits& limits,
+                            const IterationCallback& onIteration,
+                            const CurrentMoveCallback& onCurrentMove);
+    void helperSearch(Board& board, SearchState& helper, size_t helperIndex, int maxDepth);
+
+    // Play line (as far as it is legal), then continue it with best moves
+    // from the TT, up to maxLength moves in total.
+    std::vector<Move> extractPV(Board& board, const std::vector<Move>& line, int maxLength);
+};
+
+#endif // SEARCH_DRIVER_H
@@ -0,0 +1,108 @@
+#include "threadPool.h"
+
+#if defined(__linux__)
+#include <sched.h>
+#endif
+
+namespace {
+
+// CPUs this process may run on, in ascending order.
+std::vector<int> allowedCpus() {
+    std::vector<int> cpus;
+#if defined(__linux__)
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    if (sched_getaffinity(0, sizeof(set), &set) == 0) {
+        for (int cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+            if (CPU_ISSET(cpu, &set)) {
+                cpus.push_back(cpu);
+            }
+        }
+    }
+#endif
+    return cpus;
+}
+
+void pinCurrentThread(int cpu) {
+#if defined(__linux__)
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    // Best effort: an unpinned worker still searches correctly.
+    sched_setaffinity(0, sizeof(set), &set);
+#else
+    (void)cpu;
+#endif
+}
+
+} // namespace
+
+void ThreadPool::resize(size_t count, bool pinThreads) {
+    for (auto& worker : workers) {
+        {
+            std::lock_guard<std::mutex> lock(worker->mutex);
+            worker->exit = true;
+        }
+        worker->wake.notify_all();
+        worker->thread.join();
+    }
+    workers.clear();
+
+    std::vector<int> cpus;
+    if (pinThreads) {
+        cpus = allowedCpus();
+    }
+    for (size_t i = 0; i < count; i++) {
+        workers.push_back(std::make_unique<Worker>());
+        int cpu = cpus.empty() ? -1 : cpus[i % cpus.size()];
+        workers.back()->thread = std::thread(&ThreadPool::workerLoop, std::ref(*workers.back()), i, cpu);
+    }
+}
+
+void ThreadPool::start(size_t index, Task task) {
+    Worker& worker = *workers[index];
+    {
+        std::lock_guard<std::mutex> lock(worker.mutex);
+        worker.task = std::move(task);
+        worker.busy = true;
+    }
+    worker.wake.notify_all();
+}
+
+void ThreadPool::wait(size_t index) {
+    Worker& worker = *workers[index];
+    std::unique_lock<std::mutex> lock(worker.mutex);
+    worker.wake.wait(lock, [&worker] { return !worker.busy; });
+}
+
+void ThreadPool::runOnAll(const Task& task) {
+    for (size_t i = 0; i < workers.size(); i++) {
+        start(i, task);
+    }
+    for (size_t i = 0; i < workers.size(); i++) {
+        wait(i);
+    }
+}
+
+void ThreadPool::workerLoop(Worker& worker, size_t index, int cpu) {
+    if (cpu >= 0) {
+        pinCurrentThread(cpu);
+    }
+
+    std::unique_lock<std::mutex> lock(worker.mutex);
+    while (true) {
+        worker.wake.wait(lock, [&worker] { return worker.busy || worker.exit; });
+        if (worker.exit) {
+            return;
+        }
+
+        Task task = std::move(worker.task);
+        lock.unlock();
+        task(index);
+        lock.lock();
+
+        worker.busy = false;
+        // The same condition variable wakes whoever is in wait().
+        worker.wake.notify_all();
+    }
+}
@@ -0,0 +1,63 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed set of long-lived worker threads. Each worker sleeps on its own
+// condition variable until it is handed a task, runs it, and goes back to
+// sleep, so searches don't pay for thread creation.
+//
+// Workers are addressed by index. With pinning enabled worker i is bound to
+// the i-th CPU the process may run on; memory a worker first touches is then
+// allocated on that CPU's NUMA node by the kernel's default policy, which is
+// how per-thread search tables end up local to their searcher.
+class ThreadPool {
+public:
+    using Task = std::function<void(size_t index)>;
+
+    ThreadPool() = default;
+    ~ThreadPool() {
+        resize(0, false);
+    }
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // Replace the workers with count new ones. All workers must be idle.
+    void resize(size_t count, bool pinThreads);
+
+    size_t size() const {
+        return workers.size();
+    }
+
+    // Hand task to an idle worker and return immediately.
+    void start(size_t index, Task task);
+
+    // Block until the worker has finished its task.
+    void wait(size_t index);
+
+    // Run task on every worker in parallel and wait for all of them.
+    void runOnAll(const Task& task);
+
+private:
+    struct Worker {
+        std::thread thread;
+        std::mutex mutex;
+        std::condition_variable wake;
+        Task task;
+        bool busy = false;
+        bool exit = false;
+    };
+
+    std::vector<std::unique_ptr<Worker>> workers;
+
+    // cpu < 0 leaves the worker free to run anywhere.
+    static void workerLoop(Worker& worker, size_t index, int cpu);
+};
+
+#endif // THREAD_POOL_H
@@ -0,0 +1,71 @@
+#include "timeManager.h"
+#include <algorithm>
+
+namespace {
+
+// Assume this many moves remain when the GUI doesn't say.
+constexpr int DEFAULT_MOVES_TO_GO = 30;
+// Never plan past this many moves, even with a long movestogo.
+constexpr int MAX_MOVES_TO_GO = 50;
+
+} // namespace
+
+void TimeManager::start(const ClockLimits& clock, Color side) {
+    startTime = Clock::now();
+    scale = 1.0;
+    instability = 0.0;
+
+    int us = static_cast<int>(side);
+    fixedTime = clock.moveTime > 0;
+    if (fixedTime) {
+        active = true;
+        softLimit = hardLimit = std::max<int64_t>(1, clock.moveTime - MOVE_OVERHEAD_MS);
+        return;
+    }
+    if (clock.time[us] <= 0) {
+        active = false;
+        softLimit = hardLimit = 0;
+        return;
+    }
+
+    active = true;
+    int64_t available = std::max<int64_t>(1, clock.time[us] - MOVE_OVERHEAD_MS);
+    int movesToGo = clock.movesToGo > 0 ? std::min(clock.movesToGo, MAX_MOVES_TO_GO) : DEFAULT_MOVES_TO_GO;
+
+    // Spread what's left over the remaining moves, and spend most of the
+    // increment since it comes back after this move.
+    int64_t optimum = available / movesToGo + clock.inc[us] * 3 / 4;
+
+    // The hard limit allows a few times the optimum for unstable positions,
+    // but never more than 80% of the clock so we cannot flag on one move.
+    hardLimit = std::min(optimum * 4, available * 8 / 10);
+    softLimit = std::min(optimum, hardLimit);
+    hardLimit = std::max<int64_t>(hardLimit, 1);
+    softLimit = std::max<int64_t>(softLimit, 1);
+}
+
+bool TimeManager::canStartIteration(int64_t lastIterationMs, int64_t prevIterationMs) const {
+    if (!active) return true;
+
+    int64_t elapsed = elapsedMs();
+    if (fixedTime) return elapsed < hardLimit;
+    if (elapsed >= softLimitMs()) return false;
+
+    // The next iteration usually costs a roughly constant multiple of the
+    // last one. If it cannot finish before the hard limit, don't start it.
+    double growth = prevIterationMs > 0 ? static_cast<double>(lastIterationMs) / prevIterationMs : 3.0;
+    growth = std::clamp(growth, 1.5, 6.0);
+    int64_t predicted = static_cast<int64_t>(lastIterationMs * growth);
+    return elapsed + predicted < hardLimit;
+}
+
+void TimeManager::update(bool bestMoveChanged, int scoreDrop) {
+    // Recent best-move changes count fully, older ones fade out.
+    instability = instability * 0.5 + (bestMoveChanged ? 1.0 : 0.0);
+    double stabilityFactor = 1.0 + 0.5 * instability;
+
+    // Up to 1.5x more time when the score fell by 100 cp or more.
+    double dropFactor = 1.0 + 0.5 * std::clamp(scoreDrop, 0, 100) / 100.0;
+
+    scale = std::min(stabilityFactor * dropFactor, 3.0);
+}
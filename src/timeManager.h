@@ -0,0 +1,62 @@
+#ifndef TIME_MANAGER_H
+#define TIME_MANAGER_H
+
+#include "types.h"
+#include <chrono>
+#include <cstdint>
+
+// Clock state handed over by the GUI with "go". Times are in milliseconds;
+// zero means "not given".
+struct ClockLimits {
+    int64_t time[2] = {0, 0};  // wtime, btime (indexed by Color)
+    int64_t inc[2] = {0, 0};   // winc, binc
+    int movesToGo = 0;
+    int64_t moveTime = 0;
+};
+
+// Turns the clock into a soft limit (don't start another iteration past
+// it) and a hard limit (abort the running iteration). The soft limit is
+// stretched while the best move is unstable or the score is dropping.
+class TimeManager {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    // Safety margin for GUI/network latency, subtracted from every budget.
+    static constexpr int64_t MOVE_OVERHEAD_MS = 30;
+
+    void start(const ClockLimits& clock, Color side);
+
+    // False when no time limit applies (depth or infinite search).
+    bool enabled() const { return active; }
+
+    int64_t elapsedMs() const {
+        return std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now() - startTime).count();
+    }
+
+    // Polled from inside the search.
+    bool hardLimitReached() const { return active && elapsedMs() >= hardLimit; }
+
+    // Called after each completed iteration. Returns true if there is
+    // enough time left for the next one, predicting its cost from how
+    // long the last iterations took. A fixed movetime has no later move to
+    // save time for: it keeps deepening until the hard limit aborts the
+    // search, and the last completed iteration's move is played.
+    bool canStartIteration(int64_t lastIterationMs, int64_t prevIterationMs) const;
+
+    // Feed back how the last iteration went so the soft limit can grow.
+    void update(bool bestMoveChanged, int scoreDrop);
+
+    int64_t softLimitMs() const { return static_cast<int64_t>(softLimit * scale); }
+    int64_t hardLimitMs() const { return hardLimit; }
+
+private:
+    Clock::time_point startTime = Clock::now();
+    bool active = false;
+    bool fixedTime = false;    // go movetime
+    int64_t softLimit = 0;
+    int64_t hardLimit = 0;
+    double scale = 1.0;        // Current stretch of the soft limit
+    double instability = 0.0;  // Decaying count of recent best-move changes
+};
+
+#endif // TIME_MANAGER_H
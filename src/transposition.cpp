@@ -0,0 +1,285 @@
+#include "transposition.h"
+#include "types.h"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <new>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+#if defined(__linux__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+constexpr size_t MB = 1024 * 1024;
+constexpr size_t LARGE_PAGE_SIZE = 2 * MB;
+
+// Below this many bytes per thread, spawning threads costs more than the memset.
+constexpr size_t MIN_CLEAR_CHUNK = 16 * MB;
+
+constexpr char TT_FILE_MAGIC[8] = {'C', 'E', 'T', 'T', 'D', 'U', 'M', 'P'};
+
+static_assert(sizeof(TTFileHeader) <= TT_FILE_HEADER_BYTES, "TT file header too large");
+
+size_t roundUp(size_t value, size_t multiple) {
+    return (value + multiple - 1) / multiple * multiple;
+}
+
+// Check a snapshot header against this build; fills error on mismatch.
+bool validateHeader(const TTFileHeader& header, uint64_t zobristFingerprint,
+                    uint64_t fileBytes, std::string& error) {
+    if (std::memcmp(header.magic, TT_FILE_MAGIC, sizeof(TT_FILE_MAGIC)) != 0) {
+        error = "not a transposition table snapshot";
+        return false;
+    }
+    if (header.entryFormatVersion != TT_ENTRY_FORMAT_VERSION || header.entrySize != sizeof(TTSlot)) {
+        error = "incompatible entry format";
+        return false;
+    }
+    if (header.zobristVersion != ZOBRIST_KEY_VERSION || header.zobristFingerprint != zobristFingerprint) {
+        error = "snapshot was hashed with different Zobrist keys";
+        return false;
+    }
+    if (header.entryCount == 0 || (header.entryCount & (header.entryCount - 1)) != 0 ||
+        fileBytes < TT_FILE_HEADER_BYTES + header.entryCount * sizeof(TTSlot)) {
+        error = "truncated or corrupt snapshot";
+        return false;
+    }
+    return true;
+}
+
+} // namespace
+
+std::string TTStats::toString() const {
+    auto percent = [](uint64_t part, uint64_t whole) {
+        return whole == 0 ? 0 : static_cast<int>(100 * part / whole);
+    };
+    std::ostringstream out;
+    out << "probes " << probes
+        << " hits " << hits << " (" << percent(hits, probes) << "%)"
+        << " depthhits " << depthHits
+        << " cutoffs " << cutoffs << " (" << percent(cutoffs, probes) << "%)"
+        << " collisions " << collisions
+        << " stores " << stores
+        << " replacements " << replacements;
+    return out.str();
+}
+
+bool TranspositionTable::allocate(size_t sizeMB) {
+    // Largest power-of-two entry count that fits in the requested size, so
+    // the index is a single mask of the key.
+    size_t requested = std::max<size_t>(sizeMB, 1) * MB;
+    size_t newCount = 1;
+    while (newCount * 2 * sizeof(TTSlot) <= requested) {
+        newCount *= 2;
+    }
+    size_t newBytes = roundUp(newCount * sizeof(TTSlot), LARGE_PAGE_SIZE);
+    AllocKind newKind = AllocKind::NONE;
+    bool newLargePages = false;
+    void* mem = nullptr;
+
+#if defined(__linux__)
+    // 1. Explicit huge pages (only succeeds if the admin reserved some).
+    mem = mmap(nullptr, newBytes, PROT_READ | PROT_WRITE,
+               MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    if (mem != MAP_FAILED) {
+        newKind = AllocKind::HUGE_MMAP;
+        newLargePages = true;
+    } else {
+        mem = nullptr;
+    }
+#endif
+
+    // 2. 2 MB aligned memory, hinted to the kernel as a transparent huge
+    //    page candidate. The alignment lets every 2 MB region be promoted.
+    if (mem == nullptr) {
+        mem = std::aligned_alloc(LARGE_PAGE_SIZE, newBytes);
+        if (mem == nullptr) {
+            return false;
+        }
+        newKind = AllocKind::ALIGNED;
+#if defined(__linux__) && defined(MADV_HUGEPAGE)
+        newLargePages = madvise(mem, newBytes, MADV_HUGEPAGE) == 0;
+#endif
+    }
+
+    allocBase = mem;
+    allocBytes = newBytes;
+    allocKind = newKind;
+    largePages = newLargePages;
+    table = static_cast<TTSlot*>(mem);
+    entryCount = newCount;
+    mask = newCount - 1;
+    return true;
+}
+
+void TranspositionTable::freeBlock(AllocKind kind, void* base, size_t bytes) {
+    switch (kind) {
+#if defined(__linux__)
+        case AllocKind::HUGE_MMAP:
+        case AllocKind::FILE_MMAP:
+            munmap(base, bytes);
+            break;
+#endif
+        case AllocKind::ALIGNED:
+            std::free(base);
+            break;
+        default:
+            break;
+    }
+}
+
+void TranspositionTable::release() {
+    freeBlock(allocKind, allocBase, allocBytes);
+    table = nullptr;
+    entryCount = 0;
+    mask = 0;
+    allocBase = nullptr;
+    allocBytes = 0;
+    allocKind = AllocKind::NONE;
+    largePages = false;
+}
+
+bool TranspositionTable::resize(size_t sizeMB, size_t threadCount) {
+    AllocKind oldKind = allocKind;
+    void* oldBase = allocBase;
+    size_t oldBytes = allocBytes;
+    if (!allocate(sizeMB)) {
+        return false;
+    }
+    freeBlock(oldKind, oldBase, oldBytes);
+    clear(threadCount);
+    return true;
+}
+
+void TranspositionTable::clear(size_t threadCount) {
+    if (threadCount == 0) {
+        threadCount = std::max(1u, std::thread::hardware_concurrency());
+    }
+    const size_t bytes = entryCount * sizeof(TTSlot);
+    threadCount = std::min(threadCount, std::max<size_t>(1, bytes / MIN_CLEAR_CHUNK));
+
+    // Each thread zeroes (and so first-touches) its own contiguous slice.
+    const size_t stride = entryCount / threadCount;
+    auto zeroSlice = [this, stride, threadCount](size_t idx) {
+        size_t start = idx * stride;
+        size_t count = (idx == threadCount - 1) ? entryCount - start : stride;
+        std::memset(static_cast<void*>(table + start), 0, count * sizeof(TTSlot));
+    };
+
+    std::vector<std::thread> workers;
+    workers.reserve(threadCount - 1);
+    for (size_t idx = 1; idx < threadCount; idx++) {
+        workers.emplace_back(zeroSlice, idx);
+    }
+    zeroSlice(0);
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+bool TranspositionTable::save(const std::string& path, uint64_t zobristFingerprint, std::string& error) const {
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out) {
+        error = "cannot open " + path + " for writing";
+        return false;
+    }
+
+    std::vector<char> headerBlock(TT_FILE_HEADER_BYTES, 0);
+    TTFileHeader header{};
+    std::memcpy(header.magic, TT_FILE_MAGIC, sizeof(TT_FILE_MAGIC));
+    header.entryFormatVersion = TT_ENTRY_FORMAT_VERSION;
+    header.entrySize = sizeof(TTSlot);
+    header.zobristVersion = ZOBRIST_KEY_VERSION;
+    header.zobristFingerprint = zobristFingerprint;
+    header.entryCount = entryCount;
+    std::memcpy(headerBlock.data(), &header, sizeof(header));
+
+    out.write(headerBlock.data(), headerBlock.size());
+    out.write(reinterpret_cast<const char*>(table), entryCount * sizeof(TTSlot));
+    if (!out) {
+        error = "write to " + path + " failed";
+        return false;
+    }
+    return true;
+}
+
+bool TranspositionTable::load(const std::string& path, uint64_t zobristFingerprint, std::string& error) {
+#if defined(__linux__)
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        error = "cannot open " + path;
+        return false;
+    }
+    struct stat st;
+    TTFileHeader header{};
+    if (fstat(fd, &st) != 0 || pread(fd, &header, sizeof(header), 0) != static_cast<ssize_t>(sizeof(header))) {
+        close(fd);
+        error = "cannot read " + path;
+        return false;
+    }
+    if (!validateHeader(header, zobristFingerprint, static_cast<uint64_t>(st.st_size), error)) {
+        close(fd);
+        return false;
+    }
+
+    // Private mapping: probes fault pages in from the file on demand and
+    // stores go to copy-on-write pages, leaving the snapshot untouched.
+    size_t mapBytes = TT_FILE_HEADER_BYTES + header.entryCount * sizeof(TTSlot);
+    void* mem = mmap(nullptr, mapBytes, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (mem == MAP_FAILED) {
+        error = "mmap of " + path + " failed";
+        return false;
+    }
+
+    release();
+    allocBase = mem;
+    allocBytes = mapBytes;
+    allocKind = AllocKind::FILE_MMAP;
+    table = reinterpret_cast<TTSlot*>(static_cast<char*>(mem) + TT_FILE_HEADER_BYTES);
+    entryCount = header.entryCount;
+    mask = entryCount - 1;
+    return true;
+#else
+    // No mmap: read the snapshot eagerly into freshly allocated memory.
+    std::ifstream in(path, std::ios::binary | std::ios::ate);
+    if (!in) {
+        error = "cannot open " + path;
+        return false;
+    }
+    uint64_t fileBytes = static_cast<uint64_t>(in.tellg());
+    TTFileHeader header{};
+    in.seekg(0);
+    if (!in.read(reinterpret_cast<char*>(&header), sizeof(header))) {
+        error = "cannot read " + path;
+        return false;
+    }
+    if (!validateHeader(header, zobristFingerprint, fileBytes, error)) {
+        return false;
+    }
+    AllocKind oldKind = allocKind;
+    void* oldBase = allocBase;
+    size_t oldBytes = allocBytes;
+    if (!allocate(std::max<size_t>(1, header.entryCount * sizeof(TTSlot) / MB))) {
+        error = "not enough memory for snapshot";
+        return false;
+    }
+    freeBlock(oldKind, oldBase, oldBytes);
+    if (entryCount != header.entryCount) {
+        clear();
+        error = "snapshot size not representable in memory";
+        return false;
+    }
+    in.seekg(TT_FILE_HEADER_BYTES);
+    in.read(reinterpret_cast<char*>(table), entryCount * sizeof(TTSlot));
+    return true;
+#endif
+}
@@ -1,9 +1,22 @@
 #ifndef TRANSPOSITION_H
 #define TRANSPOSITION_H
 
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
 #include <cstdint>
-#include <unordered_map>
+#include <new>
+#include <string>
+#include "types.h"
 #include "moveGenerator.h"
+#include "eval.h"
+
+// TT_STATS (see types.h): each thread counts into its own TTStats.
+#if TT_STATS
+#define TT_COUNT(counter) (ttThreadStats.counter++)
+#else
+#define TT_COUNT(counter) ((void)0)
+#endif
 
 // Transposition table entry flags
 enum class TTFlag : uint8_t {
@@ -12,7 +25,7 @@ enum class TTFlag : uint8_t {
     UPPERBOUND  // Beta cutoff (fail-low)
 };
 
-// Transposition table entry
+// Transposition table entry, as read back from a TTSlot
 struct TTEntry {
     uint64_t zobristKey;  // Full key for verification
     int score;            // Position score
@@ -20,64 +33,239 @@ struct TTEntry {
     TTFlag flag;          // Type of bound
     Move bestMove;        // Best move from this position
 
-    TTEntry() : zobristKey(0), score(0), depth(0), flag(TTFlag::EXACT) {}
+    TTEntry() : zobristKey(0), score(0), depth(0), flag(TTFlag::EXACT), bestMove{} {}
 };
 
+// One table slot. Search threads share the table without locks, so an
+// entry is packed into a single data word, and the key is stored XORed
+// with it. A probe that reads the two words from different writes (or
+// halfway through one) recovers the wrong key and sees a miss, never a
+// mix of two entries. Both words are relaxed atomics, which on 64-bit
+// targets compile to plain loads and stores.
+//
+// Data word, from bit 0: score (24, signed), depth (8, signed), flag (2),
+// move from (6), to (6), promotion type (3), capture, promotion, en
+// passant and castling flags (1 each). All zero is an empty slot.
+struct TTSlot {
+    std::atomic<uint64_t> keyXorData{0};
+    std::atomic<uint64_t> data{0};
+
+    static uint64_t pack(int score, int depth, TTFlag flag, const Move& move) {
+        return (static_cast<uint64_t>(score) & 0xFFFFFF) |
+               (static_cast<uint64_t>(depth) & 0xFF) << 24 |
+               static_cast<uint64_t>(flag) << 32 |
+               static_cast<uint64_t>(move.startSquare) << 34 |
+               static_cast<uint64_t>(move.targetSquare) << 40 |
+               static_cast<uint64_t>(move.promotionType) << 46 |
+               static_cast<uint64_t>(move.isCapture) << 49 |
+               static_cast<uint64_t>(move.isPromotion) << 50 |
+               static_cast<uint64_t>(move.isEnPassant) << 51 |
+               static_cast<uint64_t>(move.isCastling) << 52;
+    }
+
+    static TTEntry unpack(uint64_t key, uint64_t data) {
+        TTEntry entry;
+        entry.zobristKey = key;
+        entry.score = static_cast<int32_t>(static_cast<uint32_t>(data << 8)) >> 8;
+        entry.depth = static_cast<int8_t>(data >> 24);
+        entry.flag = static_cast<TTFlag>((data >> 32) & 3);
+        entry.bestMove.startSquare = (data >> 34) & 63;
+        entry.bestMove.targetSquare = (data >> 40) & 63;
+        entry.bestMove.promotionType = static_cast<PieceType>((data >> 46) & 7);
+        entry.bestMove.isCapture = (data >> 49) & 1;
+        entry.bestMove.isPromotion = (data >> 50) & 1;
+        entry.bestMove.isEnPassant = (data >> 51) & 1;
+        entry.bestMove.isCastling = (data >> 52) & 1;
+        return entry;
+    }
+
+    // Key of the entry in this slot (0 when empty), with its data word.
+    uint64_t readKey(uint64_t& dataOut) const {
+        dataOut = data.load(std::memory_order_relaxed);
+        return keyXorData.load(std::memory_order_relaxed) ^ dataOut;
+    }
+
+    void write(uint64_t key, uint64_t newData) {
+        keyXorData.store(key ^ newData, std::memory_order_relaxed);
+        data.store(newData, std::memory_order_relaxed);
+    }
+};
+static_assert(sizeof(TTSlot) == 16, "TTSlot must be two packed words");
+static_assert(MATE_BOUND + MAX_PLY < (1 << 23), "TT score field too narrow");
+
+// Bump whenever the layout or meaning of TTSlot changes so old snapshots
+// are rejected. 2: mate scores stored relative to the entry's position.
+// 3: packed lockless TTSlot.
+constexpr uint32_t TT_ENTRY_FORMAT_VERSION = 3;
+
+// On-disk snapshot header. The entries follow at TT_FILE_HEADER_BYTES so the
+// mapped table stays page aligned.
+struct TTFileHeader {
+    char magic[8];               // "CETTDUMP"
+    uint32_t entryFormatVersion; // TT_ENTRY_FORMAT_VERSION at save time
+    uint32_t entrySize;          // sizeof(TTSlot) at save time
+    uint32_t zobristVersion;     // ZOBRIST_KEY_VERSION at save time
+    uint32_t reserved;
+    uint64_t zobristFingerprint; // Board::zobristFingerprint() at save time
+    uint64_t entryCount;         // Power of two
+};
+constexpr size_t TT_FILE_HEADER_BYTES = 4096;
+
+// TT counters of one search thread, or summed over several.
+struct TTStats {
+    uint64_t probes = 0;       // Calls to probe()
+    uint64_t hits = 0;         // Probes whose key matched
+    uint64_t depthHits = 0;    // Hits with enough depth to use the score
+    uint64_t cutoffs = 0;      // Hits whose bound allowed an immediate return
+    uint64_t collisions = 0;   // Probes that found a different position in the slot
+    uint64_t stores = 0;       // Entries written
+    uint64_t replacements = 0; // Writes that evicted a different position
+
+    TTStats& operator+=(const TTStats& other) {
+        probes += other.probes;
+        hits += other.hits;
+        depthHits += other.depthHits;
+        cutoffs += other.cutoffs;
+        collisions += other.collisions;
+        stores += other.stores;
+        replacements += other.replacements;
+        return *this;
+    }
+
+    // One-line summary, e.g. for a UCI "info string".
+    std::string toString() const;
+};
+
+#if TT_STATS
+// Counters of the calling thread since it last reset them. Threads share
+// the table but never a counter.
+inline thread_local TTStats ttThreadStats;
+#endif
+
 // Transposition table class
+//
+// A flat, power-of-two sized array of entries indexed by the low bits of the
+// Zobrist key. The backing memory is requested with 2 MB pages when the
+// kernel allows it, which keeps TLB misses down on random probes into large
+// tables, and falls back to normal pages otherwise.
+//
+// The table can also be snapshotted to disk and mapped back in, so analysis
+// sessions keep their knowledge across restarts.
 class TranspositionTable {
 private:
-    std::unordered_map<uint64_t, TTEntry> table;
-    size_t maxSize;
+    enum class AllocKind : uint8_t { NONE, HUGE_MMAP, ALIGNED, FILE_MMAP };
+
+    TTSlot* table = nullptr;
+    size_t entryCount = 0;
+    size_t mask = 0;
+    void* allocBase = nullptr;   // Start of the allocation (before any file header)
+    size_t allocBytes = 0;
+    AllocKind allocKind = AllocKind::NONE;
+    bool largePages = false;
+
+    // Allocate a table of at most sizeMB and make it current. Returns false,
+    // leaving the current table untouched, if the memory is not available.
+    bool allocate(size_t sizeMB);
+    void release();
+    static void freeBlock(AllocKind kind, void* base, size_t bytes);
+
+    TTSlot& slot(uint64_t key) const {
+        return table[key & mask];
+    }
 
 public:
     TranspositionTable(size_t sizeMB = 128) {
-        // Calculate number of entries based on MB
-        maxSize = (sizeMB * 1024 * 1024) / sizeof(TTEntry);
-        table.reserve(maxSize / 2);
-    }
-
-    // Store position in TT
-    void store(uint64_t key, int score, int depth, TTFlag flag, const Move& bestMove) {
-        // Replace if deeper search or empty
-        auto it = table.find(key);
-        if (it == table.end() || it->second.depth <= depth) {
-            TTEntry entry;
-            entry.zobristKey = key;
-            entry.score = score;
-            entry.depth = depth;
-            entry.flag = flag;
-            entry.bestMove = bestMove;
-            table[key] = entry;
-
-            // Simple replacement scheme: clear oldest entries if too large
-            if (table.size() > maxSize) {
-                clear();
+        if (!allocate(sizeMB)) {
+            throw std::bad_alloc();
+        }
+        clear();
+    }
+    ~TranspositionTable() {
+        release();
+    }
+    TranspositionTable(const TranspositionTable&) = delete;
+    TranspositionTable& operator=(const TranspositionTable&) = delete;
+
+    // Reallocate the table for a new size in MB. The new table is empty.
+    // The new block is allocated before the old one is freed; if it cannot
+    // be, false is returned and the current table is kept as it is.
+    bool resize(size_t sizeMB, size_t threadCount = 0);
+
+    // Write the table to path. zobristFingerprint identifies the key set
+    // the entries were hashed with (see Board::zobristFingerprint()).
+    bool save(const std::string& path, uint64_t zobristFingerprint, std::string& error) const;
+
+    // Replace the table with a snapshot written by save(). The file is
+    // mapped copy-on-write, so pages are read lazily on first probe and the
+    // file itself is never modified. On failure the current table is kept.
+    bool load(const std::string& path, uint64_t zobristFingerprint, std::string& error);
+
+    // Mate scores count plies from the root, but an entry can be reached at
+    // any ply. They are stored as distance from the entry's own position
+    // and converted back for the ply they are probed at.
+    static int scoreToTT(int score, int ply) {
+        if (score >= MATE_BOUND) return score + ply;
+        if (score <= -MATE_BOUND) return score - ply;
+        return score;
+    }
+    static int scoreFromTT(int score, int ply) {
+        if (score >= MATE_BOUND) return score - ply;
+        if (score <= -MATE_BOUND) return score + ply;
+        return score;
+    }
+
+    // Store position in TT; ply is the distance from the search root.
+    void store(uint64_t key, int score, int depth, TTFlag flag, const Move& bestMove, int ply = 0) {
+        TTSlot& target = slot(key);
+        uint64_t oldData;
+        const uint64_t oldKey = target.readKey(oldData);
+        const int oldDepth = TTSlot::unpack(oldKey, oldData).depth;
+
+        // Replace a different position unless this is a quiescence result
+        // (depth < 0 is only stored by qsearch) about to evict a real
+        // search; for the same position keep the deeper search.
+        if ((oldKey != key && (depth >= 0 || oldDepth <= 0)) || oldDepth <= depth) {
+            TT_COUNT(stores);
+            if (oldKey != key && oldData != 0) {
+                TT_COUNT(replacements);
             }
+            target.write(key, TTSlot::pack(scoreToTT(score, ply), depth, flag, bestMove));
         }
     }
 
-    // Probe TT for position
-    bool probe(uint64_t key, int depth, int alpha, int beta, int& score, Move& bestMove) {
-        auto it = table.find(key);
-        if (it == table.end() || it->second.zobristKey != key) {
+    // Probe TT for position; ply as for store().
+    bool probe(uint64_t key, int depth, int alpha, int beta, int& score, Move& bestMove,
+               int ply = 0) const {
+        TT_COUNT(probes);
+        uint64_t data;
+        if (slot(key).readKey(data) != key) {
+            if (data != 0) {
+                TT_COUNT(collisions);
+            }
             return false;
         }
+        const TTEntry entry = TTSlot::unpack(key, data);
 
-        TTEntry& entry = it->second;
+        TT_COUNT(hits);
         bestMove = entry.bestMove;
 
         // Only use score if depth is sufficient
         if (entry.depth >= depth) {
+            TT_COUNT(depthHits);
+            int entryScore = scoreFromTT(entry.score, ply);
             if (entry.flag == TTFlag::EXACT) {
-                score = entry.score;
+                TT_COUNT(cutoffs);
+                score = entryScore;
                 return true;
             }
-            if (entry.flag == TTFlag::LOWERBOUND && entry.score >= beta) {
-                score = entry.score;
+            if (entry.flag == TTFlag::LOWERBOUND && entryScore >= beta) {
+                TT_COUNT(cutoffs);
+                score = entryScore;
                 return true;
             }
-            if (entry.flag == TTFlag::UPPERBOUND && entry.score <= alpha) {
-                score = entry.score;
+            if (entry.flag == TTFlag::UPPERBOUND && entryScore <= alpha) {
+                TT_COUNT(cutoffs);
+                score = entryScore;
                 return true;
             }
         }
@@ -85,22 +273,74 @@ public:
         return false;
     }
 
+    // Copy out the whole entry for key, score converted for ply; false if
+    // the slot holds another position. For decisions that depend on the
+    // entry's depth and bound rather than on a cutoff.
+    bool lookup(uint64_t key, TTEntry& result, int ply = 0) const {
+        uint64_t data;
+        if (slot(key).readKey(data) != key) {
+            return false;
+        }
+        result = TTSlot::unpack(key, data);
+        result.score = scoreFromTT(result.score, ply);
+        return true;
+    }
+
     // Get best move from TT (for move ordering)
-    bool getBestMove(uint64_t key, Move& bestMove) {
-        auto it = table.find(key);
-        if (it != table.end() && it->second.zobristKey == key) {
-            bestMove = it->second.bestMove;
+    bool getBestMove(uint64_t key, Move& bestMove) const {
+        uint64_t data;
+        if (slot(key).readKey(data) == key) {
+            bestMove = TTSlot::unpack(key, data).bestMove;
             return true;
         }
         return false;
     }
 
-    void clear() {
-        table.clear();
+    // Zero every entry, splitting the work across threadCount threads
+    // (0 = one per hardware thread).
+    void clear(size_t threadCount = 0);
+
+    // Occupancy in permille (UCI "hashfull"), sampled from the first 1000
+    // slots. Entries are never aged out, so this only grows until clear().
+    int hashfull() const {
+        size_t sample = std::min<size_t>(1000, entryCount);
+        size_t used = 0;
+        for (size_t i = 0; i < sample; i++) {
+            used += table[i].data.load(std::memory_order_relaxed) != 0;
+        }
+        return sample == 0 ? 0 : static_cast<int>(used * 1000 / sample);
     }
 
+    // Number of entry slots in the table.
     size_t size() const {
-        return table.size();
+        return entryCount;
+    }
+
+    // Memory used by the entries, in MB (rounded up).
+    size_t sizeMB() const {
+        constexpr size_t MB = 1024 * 1024;
+        return (entryCount * sizeof(TTSlot) + MB - 1) / MB;
+    }
+
+    // The calling thread's counters since resetThreadStats(); all zero when
+    // TT_STATS is off.
+    static TTStats threadStats() {
+#if TT_STATS
+        return ttThreadStats;
+#else
+        return TTStats{};
+#endif
+    }
+
+    static void resetThreadStats() {
+#if TT_STATS
+        ttThreadStats = TTStats{};
+#endif
+    }
+
+    // True when the table is backed by 2 MB pages (explicit or transparent).
+    bool usesLargePages() const {
+        return largePages;
     }
 };
 
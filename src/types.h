@@ -4,6 +4,12 @@
 #include <cctype>
 #include <array>
 #include <cstdint>
+// Hit/probe counters of the transposition table and the evaluation caches
+// are compiled out unless the build defines TT_STATS=1 (e.g. for tuning
+// their sizes).
+#ifndef TT_STATS
+#define TT_STATS 0
+#endif
 enum class PieceType { PAWN, KNIGHT, BISHOP, ROOK, QUEEN, KING,NONE };
 enum class Color { WHITE, BLACK, NONE };
 enum Square {
@@ -47,9 +53,12 @@ enum class GameResult {
     WHITE_CHECKMATE,
     BLACK_CHECKMATE
 };
+// Bump whenever initZobristArray's seed or draw order changes; on-disk
+// transposition table snapshots record it and are rejected on mismatch.
+constexpr uint32_t ZOBRIST_KEY_VERSION = 1;
 struct ZobristArray{
     std::array<std::array<uint64_t, 12>, 64> ZobristArray;
-    int blackToMove; //1 when black is to move
+    uint64_t blackToMove; // XORed in when black is to move
     std::array<uint64_t, 4> castleRights;
     std::array<uint64_t, 8> enPassantFiles;
 };
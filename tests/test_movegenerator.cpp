@@ -125,6 +125,132 @@ void testMakeAndUndoMove() {
     std::cout << "Make move and undo move test passed.\n";
 }
 
+// Recursively play every move to the given depth and check that the
+// incrementally updated Zobrist key matches a key computed from scratch.
+void checkZobristRecursive(Board& board, int depth) {
+    Board fresh;
+    fresh.board_from_fen_string(board.getFEN());
+    assert(fresh.getZobristHash() == board.getZobristHash() && "Incremental Zobrist key diverged.");
+    assert(fresh.getPawnKey() == board.getPawnKey() && "Incremental pawn key diverged.");
+    if (depth == 0) return;
+
+    std::vector<Move> moves;
+    board.generateMoves(moves);
+    for (const auto& move : moves) {
+        uint64_t before = board.getZobristHash();
+        board.makeMove(move);
+        checkZobristRecursive(board, depth - 1);
+        board.unMakeMove();
+        assert(board.getZobristHash() == before && "Zobrist key not restored after undo.");
+    }
+}
+
+void testIncrementalZobrist() {
+    // Covers castling, rook captures, promotions and en passant.
+    Board board;
+    board.board_from_fen_string("r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1");
+    checkZobristRecursive(board, 2);
+    board.board_from_fen_string("r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1");
+    checkZobristRecursive(board, 2);
+    board.board_from_fen_string("8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1");
+    checkZobristRecursive(board, 3);
+    std::cout << "Incremental Zobrist test passed.\n";
+}
+
+void testNullMove() {
+    // Black just played c7c5, so there is an en passant square to clear.
+    Board board;
+    board.board_from_fen_string("rnbqkbnr/pp1ppppp/8/2pP4/8/8/PPP1PPPP/RNBQKBNR w KQkq c6 0 2");
+    Board before = board;
+    uint64_t keyBefore = board.getZobristHash();
+
+    board.makeNullMove();
+    assert(board.turn == Color::BLACK && board.enPassantTarget == -1);
+    Board fresh;
+    fresh.board_from_fen_string(board.getFEN());
+    assert(fresh.getZobristHash() == board.getZobristHash() && "Null move key diverged.");
+    assert(board.getPawnKey() == before.getPawnKey());
+
+    board.unmakeNullMove();
+    assert(board == before && board.getZobristHash() == keyBefore && "Null move not undone.");
+    std::cout << "Null move test passed.\n";
+}
+
+void testSEE() {
+    struct Case { const char* fen; const char* move; int expected; };
+    const Case cases[] = {
+        {"1k1r4/1pp4p/p7/4p3/8/P5P1/1PP4P/2K1R3 w - - 0 1", "e1e5", 100},
+        {"1k1r3q/1ppn3p/p4b2/4p3/8/P2N2P1/1PP1R1BP/2K1Q3 w - - 0 1", "d3e5", -250},
+        // Equal trade, and a queen taking a defended pawn.
+        {"4k3/8/2p5/3p4/4P3/8/8/4K3 w - - 0 1", "e4d5", 0},
+        {"4k3/8/4p3/3p4/8/8/8/3QK3 w - - 0 1", "d1d5", -900},
+        // The queen behind the rook joins the exchange.
+        {"3rk3/8/8/3p4/8/8/3R4/3QK3 w - - 0 1", "d2d5", 100},
+    };
+    for (const Case& c : cases) {
+        Board board;
+        board.board_from_fen_string(c.fen);
+        Move move = board.parseMove(c.move);
+        assert(board.see(move) == c.expected && "Unexpected SEE value.");
+        assert(board.see_ge(move, c.expected) && !board.see_ge(move, c.expected + 1));
+    }
+    std::cout << "SEE test passed.\n";
+}
+
+void testDrawDetection() {
+    // Knights out and back: the start position repeats after four plies.
+    Board board;
+    const char* shuffle[] = {"g1f3", "g8f6", "f3g1", "f6g8"};
+    for (const char* move : shuffle) board.makeMove(board.parseMove(move));
+    assert(board.isDraw(4) && "Repetition inside the search tree not detected.");
+    assert(!board.isDraw(0) && "A single repetition before the root is not yet a draw.");
+    for (const char* move : shuffle) board.makeMove(board.parseMove(move));
+    assert(board.isDraw(0) && board.isThreefoldRepetition());
+
+    // A pass in between breaks the repetition: after it the white king
+    // triangulates back and the original position recurs eight plies on.
+    Board passed;
+    passed.board_from_fen_string("4k3/8/8/8/8/8/8/R3K3 w - - 0 1");
+    passed.makeNullMove();
+    const char* triangle[] = {"e8d8", "e1d1", "d8e8", "d1d2", "e8d8", "d2e1", "d8e8"};
+    for (const char* move : triangle) passed.makeMove(passed.parseMove(move));
+    assert(!passed.isDraw(8) && "Repetition counted across a null move.");
+
+    // Loading a FEN starts a fresh history.
+    board.board_from_fen_string(board.startFEN);
+    assert(!board.isDraw(0) && !board.isThreefoldRepetition());
+
+    Board fifty, material;
+    fifty.board_from_fen_string("4k3/8/8/8/8/8/4P3/4K3 w - - 100 80");
+    material.board_from_fen_string("4k3/8/8/8/8/3NK3/8/8 w - - 0 1");
+    assert(fifty.isDraw(0) && material.isDraw(0));
+    // Mate delivered on the hundredth half-move stands; a mere check
+    // there is still a draw.
+    Board mated, checked;
+    mated.board_from_fen_string("R5k1/5ppp/8/8/8/8/8/6K1 b - - 100 80");
+    checked.board_from_fen_string("R5k1/5p1p/8/8/8/8/8/6K1 b - - 100 80");
+    assert(!mated.isDraw(0) && "Checkmate scored as a fifty-move draw.");
+    assert(checked.isDraw(0));
+
+    // Black to move can play Ng8 back into the start position, three plies
+    // up the line; that only counts when the line lies inside the tree.
+    Board shuffling;
+    for (int i = 0; i < 3; i++) shuffling.makeMove(shuffling.parseMove(shuffle[i]));
+    assert(shuffling.hasUpcomingRepetition(4) && !shuffling.hasUpcomingRepetition(3));
+    // The rook took the long way round to a4; it could only go straight
+    // back to a1 if the a-file were clear.
+    const char* detour[] = {"a1b1", "e8d8", "b1b4", "d8e8", "b4a4"};
+    Board open, blocked;
+    open.board_from_fen_string("4k3/8/8/8/8/8/8/R3K3 w - - 0 1");
+    blocked.board_from_fen_string("4k3/8/8/8/8/8/P7/R3K3 w - - 0 1");
+    for (const char* move : detour) {
+        open.makeMove(open.parseMove(move));
+        blocked.makeMove(blocked.parseMove(move));
+    }
+    assert(open.hasUpcomingRepetition(6) && !blocked.hasUpcomingRepetition(6));
+    std::cout << "Draw detection test passed.\n";
+}
+
 int main() {
     std::cout << "Running move generator and move execution tests...\n";
     testPawnMoves();
@@ -132,6 +258,10 @@ int main() {
     testSlidingMoves();
     testKingMoves();
     testMakeAndUndoMove();
+    testIncrementalZobrist();
+    testNullMove();
+    testSEE();
+    testDrawDetection();
     std::cout << "All tests passed.\n";
     return 0;
 }
@@ -0,0 +1,127 @@
+// tests/test_transposition.cpp
+#include "board.h"
+#include "transposition.h"
+#include <cassert>
+#include <cstddef>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+// Helper: store one exact entry for key and check it probes back.
+void storeAndProbe(TranspositionTable& tt, uint64_t key) {
+    Move move{12, 28};
+    tt.store(key, 42, 5, TTFlag::EXACT, move);
+    int score = 0;
+    Move found;
+    assert(tt.probe(key, 5, -100, 100, score, found) && "Stored entry not found.");
+    assert(score == 42 && found.sameAs(move) && "Stored entry came back changed.");
+}
+
+void testOversizedResize() {
+    TranspositionTable tt(1);
+    const size_t entries = tt.size();
+    storeAndProbe(tt, 0x1234567890abcdefULL);
+
+    // An exabyte can never be allocated: the old table must survive intact.
+    assert(!tt.resize(size_t(1) << 40) && "Oversized resize reported success.");
+    assert(tt.size() == entries && "Failed resize changed the table.");
+    storeAndProbe(tt, 0x0fedcba987654321ULL);
+
+    assert(tt.resize(2) && tt.size() >= entries);
+    storeAndProbe(tt, 0x1234567890abcdefULL);
+    std::cout << "Oversized resize test passed.\n";
+}
+
+void testPackedEntry() {
+    // Every field survives the trip through the packed data word,
+    // including negative scores and quiescence depths.
+    TranspositionTable tt(1);
+    Move promotion{52, 61, true, true, false, false, PieceType::KNIGHT};
+    const uint64_t key = 0x1122334455667788ULL;
+    tt.store(key, -CHECKMATE_SCORE + 7, -1, TTFlag::UPPERBOUND, promotion, 3);
+    TTEntry entry;
+    assert(tt.lookup(key, entry, 3));
+    assert(entry.score == -CHECKMATE_SCORE + 7 && entry.depth == -1 && entry.flag == TTFlag::UPPERBOUND);
+    assert(entry.bestMove.sameAs(promotion) && entry.bestMove.isCapture && entry.bestMove.isPromotion &&
+           !entry.bestMove.isEnPassant && !entry.bestMove.isCastling);
+    assert(!tt.lookup(key ^ 1, entry) && "Probe matched another key.");
+    std::cout << "Packed entry test passed.\n";
+}
+
+// Helper: copy the snapshot at from to to, with patch applied to its bytes.
+template <typename Patch>
+std::string patchedCopy(const std::string& from, const std::string& to, Patch patch) {
+    std::ifstream in(from, std::ios::binary);
+    std::vector<char> bytes((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    patch(bytes);
+    std::ofstream out(to, std::ios::binary | std::ios::trunc);
+    out.write(bytes.data(), bytes.size());
+    return to;
+}
+
+void testSnapshots() {
+    const uint64_t fingerprint = Board().zobristFingerprint();
+    const std::filesystem::path dir = std::filesystem::temp_directory_path();
+    const std::string path = (dir / "test_transposition.tt").string();
+    const uint64_t savedKey = 0x0123456789abcdefULL;
+    const uint64_t keptKey = 0x7766554433221100ULL;
+    std::string error;
+
+    TranspositionTable saved(1);
+    storeAndProbe(saved, savedKey);
+    assert(saved.save(path, fingerprint, error) && "Snapshot save failed.");
+
+    TranspositionTable loaded(2);
+    assert(loaded.load(path, fingerprint, error) && "Snapshot load failed.");
+    assert(loaded.size() == saved.size());
+    int score = 0;
+    Move move;
+    assert(loaded.probe(savedKey, 5, -100, 100, score, move) && score == 42 && "Saved entry lost.");
+
+    // Every rejected snapshot must leave the current table as it was.
+    TranspositionTable current(2);
+    const size_t entries = current.size();
+    storeAndProbe(current, keptKey);
+    auto rejects = [&](const std::string& file, uint64_t withFingerprint) {
+        error.clear();
+        bool ok = current.load(file, withFingerprint, error);
+        int keptScore = 0;
+        Move keptMove;
+        return !ok && !error.empty() && current.size() == entries &&
+               current.probe(keptKey, 5, -100, 100, keptScore, keptMove) && keptScore == 42;
+    };
+
+    const std::string patched = (dir / "test_transposition_bad.tt").string();
+    assert(rejects(patchedCopy(path, patched, [](std::vector<char>& b) { b[0] = 'X'; }), fingerprint) &&
+           "Wrong magic accepted.");
+    assert(rejects(patchedCopy(path, patched, [](std::vector<char>& b) {
+               uint32_t version = TT_ENTRY_FORMAT_VERSION + 1;
+               std::memcpy(&b[offsetof(TTFileHeader, entryFormatVersion)], &version, sizeof(version));
+           }), fingerprint) && "Wrong entry format version accepted.");
+    assert(rejects(patchedCopy(path, patched, [](std::vector<char>& b) {
+               uint32_t size = sizeof(TTSlot) * 2;
+               std::memcpy(&b[offsetof(TTFileHeader, entrySize)], &size, sizeof(size));
+           }), fingerprint) && "Wrong entry size accepted.");
+    assert(rejects(path, fingerprint ^ 1) && "Wrong Zobrist fingerprint accepted.");
+    assert(rejects(patchedCopy(path, patched, [](std::vector<char>& b) { b.resize(b.size() / 2); }),
+                   fingerprint) && "Truncated snapshot accepted.");
+    assert(rejects((dir / "test_transposition_missing.tt").string(), fingerprint) &&
+           "Missing snapshot accepted.");
+
+    std::filesystem::remove(path);
+    std::filesystem::remove(patched);
+    std::cout << "Snapshot test passed.\n";
+}
+
+int main() {
+    std::cout << "Running transposition table tests...\n";
+    testPackedEntry();
+    testOversizedResize();
+    testSnapshots();
+    std::cout << "All tests passed.\n";
+    return 0;
+}
@@ -4,14 +4,37 @@
 #include "src/utils.h"
 #include "src/transposition.h"
 #include "src/moveOrdering.h"
+#include "src/searchDriver.h"
+#include <algorithm>
+#include <chrono>
+#include <thread>
 #include <iostream>
+#include <mutex>
 #include <sstream>
 #include <string>
 #include <vector>
 
-// Global transposition table and killer moves
+// Global transposition table and the search driver that uses it
 TranspositionTable tt(128);
-KillerMoves killers;
+SearchDriver driver(tt);
+
+// The search runs on the driver's thread pool so stop, ponderhit and isready
+// are handled while it thinks. Both sides write through sendLine().
+std::mutex outputMutex;
+bool pinThreads = false;
+int multiPV = 1;
+constexpr int MAX_MULTI_PV = 64;
+constexpr int MAX_EVAL_CACHE_MB = 1024;
+
+void sendLine(const std::string& line) {
+    std::lock_guard<std::mutex> lock(outputMutex);
+    std::cout << line << std::endl;
+}
+
+void stopSearch() {
+    driver.signals.stop = true;
+    driver.wait();
+}
 
 // Helper function to find a legal move matching UCI notation
 Move findLegalMove(Board& board, const std::string& uciMove) {
@@ -56,6 +79,98 @@ Move findLegalMove(Board& board, const std::string& uciMove) {
     return Move{};  // Invalid move
 }
 
+// UCI score: "cp <centipawns>", or "mate <moves>" (negative when we are
+// the side getting mated).
+std::string formatScore(int score) {
+    if (score >= MATE_BOUND) {
+        return "mate " + std::to_string((CHECKMATE_SCORE - score + 1) / 2);
+    }
+    if (score <= -MATE_BOUND) {
+        return "mate " + std::to_string(-(CHECKMATE_SCORE + score) / 2);
+    }
+    return "cp " + std::to_string(score);
+}
+
+// One info line per MultiPV line; "multipv k" only when there are several.
+void sendIterationInfo(const SearchResult& iteration) {
+    int64_t nps = static_cast<int64_t>(iteration.nodes) * 1000 / std::max<int64_t>(iteration.timeMs, 1);
+    int hashfull = tt.hashfull();
+    for (size_t k = 0; k < iteration.lines.size(); k++) {
+        const PVLine& line = iteration.lines[k];
+        std::ostringstream info;
+        info << "info depth " << iteration.depth
+             << " seldepth " << std::max(iteration.selDepth, iteration.depth);
+        if (iteration.lines.size() > 1) {
+            info << " multipv " << (k + 1);
+        }
+        info << " score " << formatScore(line.score)
+             << " nodes " << iteration.nodes
+             << " nps " << nps
+             << " hashfull " << hashfull
+             << " tbhits 0"
+             << " time " << iteration.timeMs;
+        if (!line.pv.empty()) {
+            info << " pv";
+            for (const Move& move : line.pv) {
+                info << " " << moveToUCI(move);
+            }
+        }
+        sendLine(info.str());
+    }
+}
+
+void sendCurrentMove(int depth, const Move& move, int moveNumber) {
+    sendLine("info depth " + std::to_string(depth) + " currmove " + moveToUCI(move) +
+             " currmovenumber " + std::to_string(moveNumber));
+}
+
+// Called on the main search thread once the search is over: report the move.
+void reportBestMove(const SearchResult& result, const SearchLimits& limits,
+                    const std::vector<Move>& legalMoves) {
+    // "go infinite" and "go ponder" must not answer before stop/ponderhit,
+    // even if the search itself has already finished.
+    while ((limits.infinite || driver.signals.ponder) && !driver.signals.stop) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    Move bestMove = result.bestMove;
+
+    // Validate the best move is actually legal
+    bool isLegal = false;
+    for (const Move& move : legalMoves) {
+        if (move.sameAs(bestMove)) {
+            isLegal = true;
+            bestMove = move;  // Use the validated move
+            break;
+        }
+    }
+
+    if (!isLegal) {
+        std::cerr << "info string Engine returned illegal move! Using first legal move instead." << std::endl;
+        bestMove = legalMoves[0];
+    }
+
+#if TT_STATS
+    EvalCache& evalCache = threadEvalCache();
+    PawnTable& pawnTable = threadPawnTable();
+    std::ostringstream stats;
+    stats << "info string evalcache probes " << evalCache.probes
+          << " hits " << evalCache.hits
+          << " hitrate " << static_cast<int>(evalCache.hitRate() * 100) << "%";
+    sendLine(stats.str());
+    sendLine("info string pawntable probes " + std::to_string(pawnTable.probes) +
+             " hits " + std::to_string(pawnTable.hits));
+    sendLine("info string tt " + result.ttStats.toString());
+#endif
+
+    std::string reply = "bestmove " + moveToUCI(bestMove);
+    // The ponder move must answer the move actually played.
+    if (isLegal && result.pv.size() >= 2 && result.pv[0].sameAs(bestMove)) {
+        reply += " ponder " + moveToUCI(result.pv[1]);
+    }
+    sendLine(reply);
+}
+
 void uci_loop() {
     std::string line, token;
     Board board;
@@ -71,18 +186,42 @@ void uci_loop() {
         if (token == "uci") {
             std::cout << "id name Chess-Engine-Optimized" << std::endl;
             std::cout << "id author Claude" << std::endl;
-            std::cout << "option name Hash type spin default 128 min 1 max 1024" << std::endl;
+            std::cout << "option name Hash type spin default 128 min 1 max 65536" << std::endl;
+            std::cout << "option name EvalCache type spin default " << DEFAULT_EVAL_CACHE_MB
+                      << " min 1 max " << MAX_EVAL_CACHE_MB << std::endl;
+            std::cout << "option name Threads type spin default 1 min 1 max " << MAX_SEARCH_THREADS << std::endl;
+            std::cout << "option name PinThreads type check default false" << std::endl;
+            const PruningMargins defaults;
+            std::cout << "option name ReverseFutilityMargin type spin default " << defaults.reverseFutility
+                      << " min 0 max 1000" << std::endl;
+            std::cout << "option name FutilityMargin type spin default " << defaults.futility
+                      << " min 0 max 1000" << std::endl;
+            std::cout << "option name RazorMargin type spin default " << defaults.razoring
+                      << " min 0 max 1000" << std::endl;
+            std::cout << "option name ProbCutMargin type spin default " << defaults.probCut
+                      << " min 0 max 1000" << std::endl;
+            std::cout << "option name MultiPV type spin default 1 min 1 max " << MAX_MULTI_PV << std::endl;
+            std::cout << "option name Ponder type check default false" << std::endl;
             std::cout << "uciok" << std::endl;
 
         } else if (token == "isready") {
-            std::cout << "readyok" << std::endl;
+            sendLine("readyok");
+
+        } else if (token == "stop") {
+            stopSearch();
+
+        } else if (token == "ponderhit") {
+            // The opponent played the expected move: the clock is ours now.
+            driver.signals.ponder = false;
 
         } else if (token == "ucinewgame") {
+            stopSearch();
             tt.clear();
-            killers.clear();
+            driver.clear();
             board.board_from_fen_string("rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1");
 
         } else if (token == "position") {
+            stopSearch();
             std::string postype;
             iss >> postype;
 
@@ -95,7 +234,7 @@ void uci_loop() {
                     std::string moveStr;
                     while (iss >> moveStr) {
                         Move move = findLegalMove(board, moveStr);
-                        if (move.startSquare >= 0 && move.targetSquare >= 0) {
+                        if (!move.isNone()) {
                             board.makeMove(move);
                         } else {
                             std::cerr << "info string Failed to parse move: " << moveStr << std::endl;
@@ -120,7 +259,7 @@ void uci_loop() {
                     std::string moveStr;
                     while (iss >> moveStr) {
                         Move move = findLegalMove(board, moveStr);
-                        if (move.startSquare >= 0 && move.targetSquare >= 0) {
+                        if (!move.isNone()) {
                             board.makeMove(move);
                         } else {
                             std::cerr << "info string Failed to parse move: " << moveStr << std::endl;
@@ -130,24 +269,41 @@ void uci_loop() {
             }
 
         } else if (token == "go") {
-            int depth = 5;  // Default depth
+            stopSearch();
+            SearchLimits limits;
+            limits.multiPV = multiPV;
+            bool depthGiven = false;
             std::string goToken;
 
             while (iss >> goToken) {
                 if (goToken == "depth") {
-                    iss >> depth;
+                    iss >> limits.depth;
+                    depthGiven = true;
                 } else if (goToken == "movetime") {
-                    // TODO: Time management
-                    int movetime;
-                    iss >> movetime;
-                } else if (goToken == "wtime" || goToken == "btime" ||
-                          goToken == "winc" || goToken == "binc") {
-                    // TODO: Time management
-                    int time;
-                    iss >> time;
+                    iss >> limits.clock.moveTime;
+                } else if (goToken == "wtime") {
+                    iss >> limits.clock.time[static_cast<int>(Color::WHITE)];
+                } else if (goToken == "btime") {
+                    iss >> limits.clock.time[static_cast<int>(Color::BLACK)];
+                } else if (goToken == "winc") {
+                    iss >> limits.clock.inc[static_cast<int>(Color::WHITE)];
+                } else if (goToken == "binc") {
+                    iss >> limits.clock.inc[static_cast<int>(Color::BLACK)];
+                } else if (goToken == "movestogo") {
+                    iss >> limits.clock.movesToGo;
+                } else if (goToken == "infinite") {
+                    limits.infinite = true;
+                } else if (goToken == "ponder") {
+                    limits.ponder = true;
                 }
             }
 
+            // Without a clock or depth, keep the old fixed depth.
+            bool timed = limits.clock.moveTime > 0 || limits.clock.time[static_cast<int>(board.turn)] > 0;
+            if (!depthGiven && !timed && !limits.infinite && !limits.ponder) {
+                limits.depth = 5;
+            }
+
             // Generate legal moves first to validate we can move
             std::vector<Move> legalMoves;
             board.generateMoves(legalMoves);
@@ -158,36 +314,46 @@ void uci_loop() {
                 continue;
             }
 
-            // Search for best move
-            size_t nodesSearched = 0;
-            Move bestMove = AlphaBetaOptimized(board, depth, NEG_INF, POS_INF,
-                                               nodesSearched, tt, killers).second;
-
-            // Validate the best move is actually legal
-            bool isLegal = false;
-            for (const Move& move : legalMoves) {
-                if (move.startSquare == bestMove.startSquare &&
-                    move.targetSquare == bestMove.targetSquare &&
-                    move.promotionType == bestMove.promotionType) {
-                    isLegal = true;
-                    bestMove = move;  // Use the validated move
-                    break;
-                }
-            }
+            // Search in the background; the search thread prints bestmove.
+            driver.signals.stop = false;
+            driver.signals.ponder = limits.ponder;
+            driver.start(board, limits, sendIterationInfo,
+                         [limits, legalMoves](const SearchResult& result) {
+                             reportBestMove(result, limits, legalMoves);
+                         },
+                         sendCurrentMove);
 
-            if (!isLegal) {
-                std::cerr << "info string Engine returned illegal move! Using first legal move instead." << std::endl;
-                bestMove = legalMoves[0];
+        } else if (token == "savehash" || token == "loadhash") {
+            // Non-standard: savehash <file> / loadhash <file>
+            stopSearch();
+            std::string path;
+            std::getline(iss >> std::ws, path);
+            if (path.empty()) {
+                std::cout << "info string usage: " << token << " <file>" << std::endl;
+                continue;
+            }
+            std::string error;
+            if (token == "savehash") {
+                if (tt.save(path, board.zobristFingerprint(), error)) {
+                    std::cout << "info string saved hash to " << path << std::endl;
+                } else {
+                    std::cout << "info string savehash failed: " << error << std::endl;
+                }
+            } else {
+                if (tt.load(path, board.zobristFingerprint(), error)) {
+                    std::cout << "info string loaded hash from " << path
+                              << " (" << tt.size() << " entries)" << std::endl;
+                } else {
+                    std::cout << "info string loadhash failed: " << error << std::endl;
+                }
             }
-
-            std::cout << "info depth " << depth
-                      << " nodes " << nodesSearched << std::endl;
-            std::cout << "bestmove " << moveToUCI(bestMove) << std::endl;
 
         } else if (token == "quit") {
+            stopSearch();
             break;
 
         } else if (token == "setoption") {
+            stopSearch();
             std::string name, nameToken, value, valueToken;
             iss >> nameToken;  // "name"
             if (nameToken == "name") {
@@ -196,12 +362,54 @@ void uci_loop() {
                     iss >> valueToken >> value;  // "value" <number>
                     if (valueToken == "value") {
                         int hashSize = std::stoi(value);
-                        tt = TranspositionTable(hashSize);
+                        if (!tt.resize(hashSize)) {
+                            std::cout << "info string Hash " << hashSize << " MB not available, keeping "
+                                      << tt.sizeMB() << " MB" << std::endl;
+                        } else if (tt.usesLargePages()) {
+                            std::cout << "info string Hash " << hashSize << " MB using large pages" << std::endl;
+                        }
+                    }
+                } else if (name == "Threads") {
+                    iss >> valueToken >> value;
+                    if (valueToken == "value") {
+                        int threads = std::stoi(value);
+                        driver.setThreadCount(std::min(std::max(threads, 1), MAX_SEARCH_THREADS), pinThreads);
+                    }
+                } else if (name == "MultiPV") {
+                    iss >> valueToken >> value;
+                    if (valueToken == "value") {
+                        multiPV = std::min(std::max(std::stoi(value), 1), MAX_MULTI_PV);
+                    }
+                } else if (name == "PinThreads") {
+                    iss >> valueToken >> value;
+                    if (valueToken == "value") {
+                        pinThreads = value == "true";
+                        driver.setThreadCount(driver.threadCount(), pinThreads);
+                    }
+                } else if (name == "ReverseFutilityMargin" || name == "FutilityMargin" ||
+                           name == "RazorMargin" || name == "ProbCutMargin") {
+                    iss >> valueToken >> value;
+                    if (valueToken == "value") {
+                        PruningMargins margins = driver.pruningMargins();
+                        int margin = std::max(std::stoi(value), 0);
+                        if (name == "ReverseFutilityMargin") margins.reverseFutility = margin;
+                        else if (name == "FutilityMargin") margins.futility = margin;
+                        else if (name == "RazorMargin") margins.razoring = margin;
+                        else margins.probCut = margin;
+                        driver.setPruningMargins(margins);
+                    }
+                } else if (name == "EvalCache") {
+                    iss >> valueToken >> value;
+                    if (valueToken == "value") {
+                        setEvalCacheSize(std::min(std::max(std::stoi(value), 1), MAX_EVAL_CACHE_MB));
                     }
                 }
             }
         }
     }
+
+    // Input closed without "quit": don't leave the search thread running.
+    stopSearch();
 }
 
 int main() {